@@ -0,0 +1,311 @@
+// throughput of the reader and the dumper over a generated corpus, without Node; the corpus is every combination
+// of optimization level, debug level and encoding over one generated script.
+//
+//   sld_bench [functions per script] [--corpus <directory>]
+//
+// --corpus also writes the compiled samples to <directory> for bench/bench.js
+
+#include <Luau/BytecodeUtils.h>
+#include <Luau/Compiler.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "../native/analysis/analysis.hpp"
+#include "../native/deserializer/deserializer.hpp"
+#include "../native/dumper/dumper.hpp"
+#include "../native/encoding/encoding.hpp"
+
+// every measurement is repeated until it took at least this long
+static constexpr double min_seconds = 0.5;
+
+// calls averaged over when counting allocations, after one warm-up call
+static constexpr size_t allocation_calls = 16;
+
+// every heap allocation the process makes, to check that reading and formatting into reused buffers doesn't allocate
+static std::atomic<size_t> allocations{0};
+
+void *operator new(size_t size)
+{
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (void *memory = malloc(size == 0 ? 1 : size))
+    return memory;
+
+  // without exceptions there is no bad_alloc to throw
+  abort();
+}
+
+void *operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void operator delete(void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void *memory) noexcept
+{
+  free(memory);
+}
+
+void operator delete(void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+void operator delete[](void *memory, size_t) noexcept
+{
+  free(memory);
+}
+
+struct Sample
+{
+  std::string name;
+  sld::BytecodeEncoding encoding;
+  std::string bytecode;
+};
+
+// encodes the way the reader decodes Roblox bytecode: the low byte of every word times 227
+struct RobloxEncoder : Luau::BytecodeEncoder
+{
+  void encode(uint32_t *data, size_t count) override
+  {
+    for (size_t i = 0; i < count; ++i)
+      data[i] = (data[i] & ~uint32_t(0xff)) | uint8_t(data[i] * 227);
+  }
+};
+
+// a module with `functions` functions covering loops, tables, closures, calls, imports and constants of every kind
+static std::string generate_script(size_t functions)
+{
+  std::string script = "local M = {}\n\n";
+  char buffer[2048];
+
+  for (size_t i = 0; i < functions; ++i)
+  {
+    snprintf(buffer, sizeof(buffer),
+             "function M.f%zu(a, b, ...)\n"
+             "  local t = { x = a, y = b, name = \"f%zu\", list = { 1, 2, 3, %zu }, v = vector(1, 2, 3) }\n"
+             "  local sum = 0\n"
+             "  for k = 1, #t.list do\n"
+             "    sum += t.list[k] * %zu + a / 3\n"
+             "  end\n"
+             "  for key, value in pairs(t) do\n"
+             "    if type(value) == \"number\" and value > %zu then\n"
+             "      sum = sum - value\n"
+             "    elseif key == \"name\" then\n"
+             "      sum = sum + #value\n"
+             "    end\n"
+             "  end\n"
+             "  local s = string.format(\"%%d:%%s\", sum, t.name) .. tostring(b)\n"
+             "  local inner = function(x) return x * sum + %zu.%zu end\n"
+             "  if select(\"#\", ...) > 0 and not t.skip then\n"
+             "    print(s, inner(sum), math.floor(sum / 2), math.max(a, b))\n"
+             "  end\n"
+             "  while sum > 100 do sum = sum // 2 end\n"
+             "  return t, sum, inner\n"
+             "end\n\n",
+             i, i, i, i % 13 + 1, i % 7, i, i % 1000);
+
+    script += buffer;
+  }
+
+  script += "return M\n";
+
+  return script;
+}
+
+// seconds one call of `body` took, on average over as many calls as fit in min_seconds
+template <typename F>
+static double time_per_call(F &&body)
+{
+  using clock = std::chrono::steady_clock;
+
+  size_t calls = 0;
+  const auto start = clock::now();
+  double elapsed = 0;
+
+  do
+  {
+    body();
+    calls++;
+    elapsed = std::chrono::duration<double>(clock::now() - start).count();
+  } while (elapsed < min_seconds);
+
+  return elapsed / double(calls);
+}
+
+// heap allocations one call of `body` makes once its buffers are warm
+template <typename F>
+static double allocations_per_call(F &&body)
+{
+  body();
+
+  const size_t before = allocations.load();
+
+  for (size_t i = 0; i < allocation_calls; ++i)
+    body();
+
+  return double(allocations.load() - before) / double(allocation_calls);
+}
+
+static size_t count_instructions(const sld::Bytecode &bytecode)
+{
+  size_t count = 0;
+
+  for (const auto &function : bytecode.functions)
+  {
+    const uint32_t *code = bytecode.code_of(function);
+
+    for (uint32_t pc = 0; pc < function.sizecode; pc += Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc]))))
+      count++;
+  }
+
+  return count;
+}
+
+// formats every instruction on its own, the way dumpFunction does minus the headers
+static void dump_instructions(const sld::Bytecode &bytecode, std::string &output)
+{
+  static sld::PcSet targets;
+  sld::Writer writer(output);
+
+  for (const auto &function : bytecode.functions)
+  {
+    const uint32_t *code = bytecode.code_of(function);
+    sld::find_jump_targets(bytecode, function, targets);
+
+    for (uint32_t pc = 0; pc < function.sizecode; pc += Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc]))))
+    {
+      sld::dumpInstruction(bytecode, function, &code[pc], writer, targets.rank(sld::jump_target(code[pc], pc)), targets.rank(int32_t(pc)));
+    }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  size_t functions = 2000;
+  const char *corpus_directory = nullptr;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--corpus") == 0 && i + 1 < argc)
+      corpus_directory = argv[++i];
+    else
+      functions = strtoull(argv[i], nullptr, 10);
+  }
+
+  const std::string script = generate_script(functions);
+
+  std::vector<Sample> corpus;
+  RobloxEncoder roblox;
+
+  for (int optimization = 0; optimization <= 2; ++optimization)
+  {
+    for (int debug = 0; debug <= 1; ++debug)
+    {
+      Luau::CompileOptions options;
+      options.optimizationLevel = optimization;
+      options.debugLevel = debug;
+
+      const std::string name = "O" + std::to_string(optimization) + "-g" + std::to_string(debug);
+
+      corpus.push_back({name + "-luau", sld::BytecodeEncoding::Luau, Luau::compile(script, options)});
+      corpus.push_back({name + "-roblox", sld::BytecodeEncoding::Roblox, Luau::compile(script, options, {}, &roblox)});
+    }
+  }
+
+  printf("%zu functions per script, %s opcode decoder\n\n", functions, sld::opcode_decoder_name());
+  printf("%-14s %10s %10s %12s %14s %14s %14s %12s %12s %12s %12s\n", "sample", "bytes", "insns", "read MB/s", "read insn/s", "dump insn/s", "listing MB/s", "read allocs", "dump allocs", "cold allocs", "const hits");
+
+  double total_bytes = 0;
+  double total_read = 0;
+  double total_instructions = 0;
+  double total_dump = 0;
+
+  for (const auto &sample : corpus)
+  {
+    sld::Bytecode bytecode;
+    sld::BytecodeError error;
+
+    if (!sld::read_bytecode(sample.bytecode, sample.encoding, bytecode, &error))
+    {
+      fprintf(stderr, "%s: %.*s\n", sample.name.c_str(), int(error.reason.size()), error.reason.data());
+      return 1;
+    }
+
+    if (corpus_directory != nullptr)
+    {
+      std::ofstream file(std::string(corpus_directory) + "/" + sample.name + ".bin", std::ios::binary);
+      file.write(sample.bytecode.data(), std::streamsize(sample.bytecode.size()));
+    }
+
+    const double instructions = double(count_instructions(bytecode));
+    const double bytes = double(sample.bytecode.size());
+
+    const auto read_call = [&]()
+    {
+      sld::read_bytecode(sample.bytecode, sample.encoding, bytecode);
+    };
+
+    std::string output;
+
+    // reused the way a Disassembler reuses its own, so allocations show the steady state
+    sld::DumpScratch scratch;
+
+    const auto dump_call = [&]()
+    {
+      output.clear();
+      dump_instructions(bytecode, output);
+    };
+
+    const auto listing_call = [&]()
+    {
+      output.clear();
+      sld::Writer writer(output);
+      sld::dumpBytecode(bytecode, writer, scratch);
+    };
+
+    const double read = time_per_call(read_call);
+    const double dump = time_per_call(dump_call);
+    const double listing = time_per_call(listing_call);
+
+    const double read_allocations = allocations_per_call(read_call);
+    const double dump_allocations = allocations_per_call(listing_call);
+
+    // what a fresh context pays before its buffers have grown to size
+    const double cold_allocations = allocations_per_call([&]()
+                                                         {
+      sld::Bytecode cold;
+      sld::read_bytecode(sample.bytecode, sample.encoding, cold); });
+
+    // share of constant operands the listing copied from an earlier rendering within the same function
+    const sld::ConstantTextStats before = sld::constant_text_stats();
+    listing_call();
+    const sld::ConstantTextStats after = sld::constant_text_stats();
+
+    const double constant_hits = double(after.hits - before.hits);
+    const double constant_references = constant_hits + double(after.misses - before.misses);
+
+    printf("%-14s %10.0f %10.0f %12.1f %14.0f %14.0f %14.1f %12.1f %12.1f %12.1f %11.1f%%\n", sample.name.c_str(), bytes, instructions, bytes / read / 1e6, instructions / read, instructions / dump, double(output.size()) / listing / 1e6, read_allocations, dump_allocations, cold_allocations, constant_references == 0 ? 0.0 : constant_hits / constant_references * 100);
+
+    total_bytes += bytes;
+    total_read += read;
+    total_instructions += instructions;
+    total_dump += dump;
+  }
+
+  printf("\n%-14s %10.0f %10.0f %12.1f %14.0f %14.0f\n", "total", total_bytes, total_instructions, total_bytes / total_read / 1e6, total_instructions / total_read, total_instructions / total_dump);
+
+  return 0;
+}
@@ -0,0 +1,82 @@
+// throughput of the node-api layer over the corpus written by the native benchmark:
+//
+//   build/Release/sld_bench --corpus bench/corpus
+//   node bench/bench.js [directory]
+
+const { readdirSync, readFileSync } = require("fs");
+const { join } = require("path");
+
+const disassembler = require("../index.cjs");
+
+// every measurement is repeated until it took at least this long
+const minMilliseconds = 500;
+
+async function timePerCall(body) {
+	let calls = 0;
+	const start = performance.now();
+	let elapsed = 0;
+
+	do {
+		await body();
+		calls++;
+		elapsed = performance.now() - start;
+	} while (elapsed < minMilliseconds);
+
+	return elapsed / calls / 1000;
+}
+
+function megabytesPerSecond(bytes, seconds) {
+	return (bytes / seconds / 1e6).toFixed(1);
+}
+
+async function main() {
+	const directory = process.argv[2] ?? join(__dirname, "corpus");
+	const names = readdirSync(directory).filter((name) => name.endsWith(".bin"));
+
+	if (names.length === 0) {
+		console.error(`no samples in ${directory}, write some with sld_bench --corpus ${directory}`);
+		process.exit(1);
+	}
+
+	const samples = names.map((name) => ({
+		name: name.slice(0, -4),
+		encoding: name.includes("roblox") ? "roblox" : undefined,
+		bytecode: readFileSync(join(directory, name)),
+	}));
+
+	const rows = [];
+
+	for (const { name, encoding, bytecode } of samples) {
+		const options = { encoding };
+
+		rows.push({
+			sample: name,
+			bytes: bytecode.length,
+			"sync MB/s": megabytesPerSecond(bytecode.length, await timePerCall(() => disassembler.disassembleBytecode(bytecode, options))),
+			"parallel MB/s": megabytesPerSecond(bytecode.length, await timePerCall(() => disassembler.disassembleBytecode(bytecode, { encoding, parallel: true }))),
+			"async MB/s": megabytesPerSecond(bytecode.length, await timePerCall(() => disassembler.disassembleBytecodeAsync(bytecode, options))),
+			"decode MB/s": megabytesPerSecond(bytecode.length, await timePerCall(() => disassembler.decodeBytecode(bytecode, options))),
+			"cfg MB/s": megabytesPerSecond(bytecode.length, await timePerCall(() => disassembler.controlFlowGraph(bytecode, options))),
+		});
+	}
+
+	console.table(rows);
+
+	// the whole corpus at once, auto-detecting the encoding of every file
+	const buffers = samples.map((sample) => sample.bytecode);
+	const totalBytes = buffers.reduce((total, buffer) => total + buffer.length, 0);
+
+	const many = await timePerCall(() => disassembler.disassembleMany(buffers, { encoding: "auto" }));
+	const stream = await timePerCall(async () => {
+		for (const bytecode of buffers) {
+			for await (const chunk of disassembler.disassembleBytecodeStream(bytecode, "auto")) {
+				// only the production of chunks is measured
+			}
+		}
+	});
+
+	console.log(`disassembleMany: ${megabytesPerSecond(totalBytes, many)} MB/s`);
+	console.log(`disassembleBytecodeStream: ${megabytesPerSecond(totalBytes, stream)} MB/s`);
+}
+
+main();
@@ -1,50 +1,8 @@
 {
+  "variables": {
+    "build_bench%": "false",
+  },
   "targets": [
-    {
-      "target_name": "luau.VM",
-      "type": "static_library",
-      "include_dirs": [
-        "deps/luau/VM/src",
-        "deps/luau/VM/include",
-        "deps/luau/Common/include",
-        "deps/luau/Compiler/include",
-        "deps/luau/Ast/include",
-      ],
-      "sources": [
-        "deps/luau/VM/src/lapi.cpp",
-        "deps/luau/VM/src/laux.cpp",
-        "deps/luau/VM/src/lbaselib.cpp",
-        "deps/luau/VM/src/lbitlib.cpp",
-        "deps/luau/VM/src/lbuffer.cpp",
-        "deps/luau/VM/src/lbuflib.cpp",
-        "deps/luau/VM/src/lbuiltins.cpp",
-        "deps/luau/VM/src/lcorolib.cpp",
-        "deps/luau/VM/src/ldblib.cpp",
-        "deps/luau/VM/src/ldebug.cpp",
-        "deps/luau/VM/src/ldo.cpp",
-        "deps/luau/VM/src/lfunc.cpp",
-        "deps/luau/VM/src/lgc.cpp",
-        "deps/luau/VM/src/lgcdebug.cpp",
-        "deps/luau/VM/src/linit.cpp",
-        "deps/luau/VM/src/lmem.cpp",
-        "deps/luau/VM/src/lmathlib.cpp",
-        "deps/luau/VM/src/lnumprint.cpp",
-        "deps/luau/VM/src/lobject.cpp",
-        "deps/luau/VM/src/loslib.cpp",
-        "deps/luau/VM/src/lperf.cpp",
-        "deps/luau/VM/src/lstate.cpp",
-        "deps/luau/VM/src/lstring.cpp",
-        "deps/luau/VM/src/lstrlib.cpp",
-        "deps/luau/VM/src/ltable.cpp",
-        "deps/luau/VM/src/ltablib.cpp",
-        "deps/luau/VM/src/ltm.cpp",
-        "deps/luau/VM/src/ludata.cpp",
-        "deps/luau/VM/src/lutf8lib.cpp",
-        "deps/luau/VM/src/lvmexecute.cpp",
-        "deps/luau/VM/src/lvmload.cpp",
-        "deps/luau/VM/src/lvmutils.cpp",
-      ]
-    },
     {
       "target_name": "luau.Ast",
       "type": "static_library",
@@ -93,8 +51,16 @@
       "sources": [
         "native/lib.cpp",
         "native/deserializer/deserializer.cpp",
+        "native/analysis/analysis.cpp",
+        "native/analysis/cfg.cpp",
+        "native/cache/cache.cpp",
+        "native/cache/hash.cpp",
         "native/disassembler/disassembler.cpp",
         "native/dumper/dumper.cpp",
+        "native/dumper/sink.cpp",
+        "native/encoding/encoding.cpp",
+        "native/io/mapped_file.cpp",
+        "native/pool/pool.cpp",
       ],
       "conditions": [
         [
@@ -113,10 +79,41 @@
         ]
       ],
       "dependencies": [
-        "luau.VM",
         "luau.Ast",
         "luau.Compiler",
       ]
     }
+  ],
+  "conditions": [
+    [
+      # node-gyp configure -- -Dbuild_bench=true
+      'build_bench=="true"', {
+        "targets": [
+          {
+            "target_name": "sld_bench",
+            "type": "executable",
+            "include_dirs": [
+              "deps/luau/VM/include",
+              "deps/luau/Common/include",
+              "deps/luau/Compiler/include",
+              "deps/luau/Ast/include",
+            ],
+            "sources": [
+              "bench/bench.cpp",
+              "native/deserializer/deserializer.cpp",
+              "native/analysis/analysis.cpp",
+              "native/dumper/dumper.cpp",
+              "native/dumper/sink.cpp",
+              "native/encoding/encoding.cpp",
+              "native/pool/pool.cpp",
+            ],
+            "dependencies": [
+              "luau.Ast",
+              "luau.Compiler",
+            ]
+          }
+        ]
+      }
+    ]
   ]
 }
\ No newline at end of file
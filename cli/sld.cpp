@@ -0,0 +1,360 @@
+// disassembles bytecode files, or whole directories of them, without Node
+//
+//   sld [options] <file or directory>...
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "disassembler/disassembler.hpp"
+#include "dumper/sink.hpp"
+#include "encoding/encoding.hpp"
+#include "io/mapped_file.hpp"
+#include "pool/pool.hpp"
+
+namespace fs = std::filesystem;
+
+static const char *usage =
+    "usage: sld [options] <file or directory>...\n"
+    "\n"
+    "  -e, --encoding <name>   luau (default), roblox or auto\n"
+    "  -c, --compile           inputs are Luau source, compile them first\n"
+    "  -o, --output <dir>      write every listing to <dir>/<input>.txt instead of stdout\n"
+    "  -x, --extension <ext>   only take files ending in <ext> from directories\n"
+    "  -j, --jobs <n>          threads to use, one per core by default\n";
+
+struct Arguments
+{
+  std::vector<std::string> inputs;
+  sld::DisassembleOptions options;
+  bool compile = false;
+  std::string output;
+  std::string extension;
+  size_t jobs = 0;
+};
+
+// a file to disassemble and where its listing goes, relative to the output directory
+struct Input
+{
+  std::string path;
+  std::string name;
+};
+
+// files written to stdout per round; bounds the listings held while waiting for an earlier file to finish
+static constexpr size_t files_per_thread = 4;
+
+static std::optional<Arguments> parse_arguments(int argc, char **argv)
+{
+  Arguments arguments;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    const std::string_view argument = argv[i];
+    const bool has_value = i + 1 < argc;
+
+    if (argument == "-e" || argument == "--encoding")
+    {
+      const auto encoding = has_value ? sld::find_encoding(argv[++i]) : std::nullopt;
+
+      if (!encoding.has_value())
+        return {};
+
+      arguments.options.encoding = encoding.value();
+    }
+    else if (argument == "-c" || argument == "--compile")
+      arguments.compile = true;
+    else if ((argument == "-o" || argument == "--output") && has_value)
+      arguments.output = argv[++i];
+    else if ((argument == "-x" || argument == "--extension") && has_value)
+      arguments.extension = argv[++i];
+    else if ((argument == "-j" || argument == "--jobs") && has_value)
+      arguments.jobs = strtoull(argv[++i], nullptr, 10);
+    else if (!argument.empty() && argument[0] == '-')
+      return {};
+    else
+      arguments.inputs.emplace_back(argument);
+  }
+
+  if (arguments.inputs.empty())
+    return {};
+
+  return arguments;
+}
+
+static bool has_extension(const fs::path &path, const std::string &extension)
+{
+  const std::string name = path.filename().string();
+
+  return extension.empty() || (name.size() >= extension.size() && name.compare(name.size() - extension.size(), extension.size(), extension) == 0);
+}
+
+// walks the directory tree one level at a time, listing every directory of a level on its own thread; entries are
+// sorted per directory so the order doesn't depend on the file system or on scheduling
+static void walk(sld::ThreadPool &pool, const fs::path &root, const fs::path &base, const std::string &extension, std::vector<Input> &files)
+{
+  struct Listing
+  {
+    std::vector<fs::path> files;
+    std::vector<fs::path> directories;
+  };
+
+  std::vector<fs::path> level{root};
+
+  while (!level.empty())
+  {
+    std::vector<Listing> listings(level.size());
+
+    pool.parallel_for(level.size(), [&](size_t index)
+                      {
+      std::error_code error;
+      auto &listing = listings[index];
+
+      for (fs::directory_iterator it(level[index], error), end; !error && it != end; it.increment(error))
+      {
+        std::error_code type_error;
+
+        if (it->is_directory(type_error))
+          listing.directories.push_back(it->path());
+        else if (it->is_regular_file(type_error) && has_extension(it->path(), extension))
+          listing.files.push_back(it->path());
+      }
+
+      if (error)
+        fprintf(stderr, "%s: %s\n", level[index].string().c_str(), error.message().c_str());
+
+      std::sort(listing.files.begin(), listing.files.end());
+      std::sort(listing.directories.begin(), listing.directories.end()); });
+
+    std::vector<fs::path> next;
+
+    for (auto &listing : listings)
+    {
+      for (auto &file : listing.files)
+        files.push_back({file.string(), file.lexically_relative(base).string()});
+
+      next.insert(next.end(), listing.directories.begin(), listing.directories.end());
+    }
+
+    level = std::move(next);
+  }
+}
+
+static std::vector<Input> collect_inputs(sld::ThreadPool &pool, const Arguments &arguments)
+{
+  std::vector<Input> files;
+
+  for (const auto &input : arguments.inputs)
+  {
+    std::error_code error;
+    const fs::path path = fs::path(input).lexically_normal();
+
+    if (fs::is_directory(path, error))
+    {
+      // listings of a named directory keep its name, those of "." or ".." start below it
+      const fs::path root = path.has_filename() ? path : path.parent_path();
+      const bool relative_root = root.filename() == "." || root.filename() == "..";
+
+      walk(pool, root, relative_root ? root : root.parent_path(), arguments.extension, files);
+    }
+    else
+      files.push_back({input, path.filename().string()});
+  }
+
+  return files;
+}
+
+static int open_output(const std::string &path)
+{
+#ifdef _WIN32
+  return _open(path.c_str(), _O_WRONLY | _O_CREAT | _O_TRUNC | _O_BINARY, 0644);
+#else
+  return ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+#endif
+}
+
+static void close_output(int fd)
+{
+#ifdef _WIN32
+  _close(fd);
+#else
+  ::close(fd);
+#endif
+}
+
+static void report(const Input &input, const std::string &reason)
+{
+  fprintf(stderr, "%s: %s\n", input.path.c_str(), reason.c_str());
+}
+
+static void report(const Input &input, const sld::BytecodeError &error)
+{
+  if (!error.detail.empty())
+    report(input, error.detail);
+  else
+    report(input, std::string(error.reason) + " (" + std::string(error.section) + " at offset " + std::to_string(error.offset) + ")");
+}
+
+// the listing of one file into `sink`; compiled scripts go through the listing the Disassembler keeps
+static bool disassemble(const Input &input, const Arguments &arguments, sld::Sink &sink)
+{
+  sld::MappedFile file;
+  std::error_code error;
+
+  if (!file.open(input.path, &error))
+  {
+    report(input, error.message());
+    return false;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+
+  if (!arguments.compile)
+  {
+    if (!disassembler.disassemble_bytecode_to(sink, file.view(), arguments.options))
+    {
+      report(input, disassembler.last_error());
+      return false;
+    }
+
+    return true;
+  }
+
+  const auto listing = disassembler.disassemble(std::string(file.view()), arguments.options);
+
+  if (!listing.has_value())
+  {
+    report(input, disassembler.last_error());
+    return false;
+  }
+
+  sink.write(listing.value());
+
+  return true;
+}
+
+// every file into its own listing under the output directory, in any order
+static bool disassemble_to_directory(sld::ThreadPool &pool, const std::vector<Input> &files, const Arguments &arguments)
+{
+  std::atomic<bool> ok{true};
+
+  pool.parallel_for(files.size(), [&](size_t index)
+                    {
+    const Input &input = files[index];
+    const fs::path output = fs::path(arguments.output) / (input.name + ".txt");
+
+    std::error_code error;
+    fs::create_directories(output.parent_path(), error);
+
+    const int fd = open_output(output.string());
+
+    if (fd < 0)
+    {
+      report(input, "can't write " + output.string());
+      ok = false;
+      return;
+    }
+
+    sld::FileSink sink(fd);
+
+    const bool written = disassemble(input, arguments, sink) && sink.ok();
+    close_output(fd);
+
+    // no listing is better than an empty or partial one
+    if (!written)
+    {
+      fs::remove(output, error);
+      ok = false;
+    } });
+
+  return ok;
+}
+
+// every listing to stdout in input order, each under a header naming its file when there are several
+static bool disassemble_to_stdout(sld::ThreadPool &pool, const std::vector<Input> &files, const Arguments &arguments)
+{
+  sld::FileSink out(1);
+  bool ok = true;
+  bool written = false;
+
+  const size_t round_size = (pool.size() + 1) * files_per_thread;
+  std::vector<std::string> listings(std::min(files.size(), round_size));
+  std::unique_ptr<bool[]> succeeded(new bool[listings.size()]);
+
+  for (size_t round = 0; round < files.size(); round += round_size)
+  {
+    const size_t round_files = std::min(round_size, files.size() - round);
+
+    pool.parallel_for(round_files, [&](size_t index)
+                      {
+      listings[index].clear();
+
+      sld::StringSink sink(listings[index]);
+      succeeded[index] = disassemble(files[round + index], arguments, sink); });
+
+    for (size_t i = 0; i < round_files; ++i)
+    {
+      ok = ok && succeeded[i];
+
+      if (!succeeded[i])
+        continue;
+
+      if (files.size() > 1)
+      {
+        out.write(written ? "\n\n-- " : "-- ");
+        out.write(files[round + i].path);
+        out.write("\n");
+      }
+
+      out.write(listings[i]);
+      written = true;
+    }
+  }
+
+  if (written)
+    out.write("\n");
+
+  return ok && out.ok();
+}
+
+int main(int argc, char **argv)
+{
+  auto arguments = parse_arguments(argc, argv);
+
+  if (!arguments.has_value())
+  {
+    fputs(usage, stderr);
+    return 2;
+  }
+
+  std::unique_ptr<sld::ThreadPool> own_pool;
+
+  if (arguments->jobs != 0)
+    own_pool = std::make_unique<sld::ThreadPool>(arguments->jobs - 1);
+
+  sld::ThreadPool &pool = own_pool != nullptr ? *own_pool : sld::ThreadPool::shared();
+
+  const std::vector<Input> files = collect_inputs(pool, arguments.value());
+
+  // a single large file is split across the pool instead
+  arguments->options.parallel = files.size() == 1;
+  arguments->options.pool = &pool;
+
+  const bool ok = arguments->output.empty() ? disassemble_to_stdout(pool, files, arguments.value()) : disassemble_to_directory(pool, files, arguments.value());
+
+  return ok ? 0 : 1;
+}
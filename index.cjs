@@ -1 +1,158 @@
-module.exports = require("./build/Release/simple_lua_disassembler");
+const { Readable } = require("stream");
+
+const native = require("./build/Release/simple_lua_disassembler");
+
+// the listing is produced in chunks on Node's thread pool and pushed into the stream as they arrive; the native side
+// pauses once push() reports a full buffer and waits for the next read(), and stops formatting when the stream is
+// destroyed
+function disassembleBytecodeStream(bytecode, options) {
+	let control = null;
+
+	const stream = new Readable({
+		read() {
+			if (control !== null) native.resumeChunks(control);
+		},
+		destroy(error, callback) {
+			if (control !== null) native.cancelChunks(control);
+			callback(error);
+		},
+	});
+
+	const chunks = native.disassembleBytecodeChunks(bytecode, options, (chunk) => !stream.destroyed && stream.push(chunk));
+	control = chunks.control;
+
+	chunks.done.then(
+		() => {
+			if (!stream.destroyed) stream.push(null);
+		},
+		(error) => stream.destroy(error)
+	);
+
+	return stream;
+}
+
+// in the order of sld::Constant::Type
+const constantTypes = ["nil", "boolean", "number", "vector", "string", "import", "table", "closure"];
+
+// the native side returns flat columns for all protos at once, every proto's arrays are views into them
+function decodeBytecode(bytecode, options) {
+	const columns = native.decodeBytecodeColumns(bytecode, options);
+	const { instructionStarts, constantStarts, protoFields } = columns;
+
+	const protos = columns.names.map((name, index) => {
+		const start = instructionStarts[index];
+		const end = instructionStarts[index + 1];
+		const fields = index * 6;
+
+		const constants = [];
+
+		for (let k = constantStarts[index]; k < constantStarts[index + 1]; k++) {
+			constants.push({ type: constantTypes[columns.constantTypes[k]], value: columns.constantValues[k] });
+		}
+
+		return {
+			name,
+			lineDefined: protoFields[fields],
+			maxStackSize: protoFields[fields + 1],
+			numParams: protoFields[fields + 2],
+			numUpvalues: protoFields[fields + 3],
+			isVararg: protoFields[fields + 4] !== 0,
+			flags: protoFields[fields + 5],
+			pc: columns.pc.subarray(start, end),
+			opcode: columns.opcode.subarray(start, end),
+			a: columns.a.subarray(start, end),
+			b: columns.b.subarray(start, end),
+			c: columns.c.subarray(start, end),
+			d: columns.d.subarray(start, end),
+			aux: columns.aux.subarray(start, end),
+			target: columns.target.subarray(start, end),
+			constants,
+		};
+	});
+
+	return {
+		version: columns.version,
+		typesVersion: columns.typesVersion,
+		mainId: columns.mainId,
+		encoding: columns.encoding,
+		strings: columns.strings,
+		protos,
+	};
+}
+
+// every proto's name, offset and sizes from a skim that doesn't read any of them
+function inspect(bytecode) {
+	const columns = native.inspectColumns(bytecode);
+	const { offsets, protoFields } = columns;
+
+	const protos = columns.names.map((name, index) => ({
+		name,
+		offset: offsets[index],
+		lineDefined: protoFields[index * 3],
+		sizeCode: protoFields[index * 3 + 1],
+		constantCount: protoFields[index * 3 + 2],
+	}));
+
+	return {
+		version: columns.version,
+		typesVersion: columns.typesVersion,
+		mainId: columns.mainId,
+		protos,
+	};
+}
+
+// basic blocks of every proto, sliced out of the flat columns the native side builds in one pass
+function controlFlowGraph(bytecode, options) {
+	const columns = native.controlFlowColumns(bytecode, options);
+	const { blockRanges, edgeRanges } = columns;
+
+	const graphs = [];
+
+	for (let index = 0; index + 1 < blockRanges.length; index++) {
+		const blockStart = blockRanges[index];
+		const blockEnd = blockRanges[index + 1];
+		const edgeStart = edgeRanges[index];
+		const edgeEnd = edgeRanges[index + 1];
+
+		// every proto's offset arrays have one more entry than it has blocks
+		const offsetStart = blockStart + index;
+		const offsetEnd = blockEnd + index + 1;
+
+		graphs.push({
+			blockStart: columns.blockStart.subarray(blockStart, blockEnd),
+			blockEnd: columns.blockEnd.subarray(blockStart, blockEnd),
+			successorOffsets: columns.successorOffsets.subarray(offsetStart, offsetEnd),
+			successors: columns.successors.subarray(edgeStart, edgeEnd),
+			predecessorOffsets: columns.predecessorOffsets.subarray(offsetStart, offsetEnd),
+			predecessors: columns.predecessors.subarray(edgeStart, edgeEnd),
+		});
+	}
+
+	return graphs;
+}
+
+// the column and chunk helpers stay private, the wrappers above are their public side
+module.exports = {
+	disassemble: native.disassemble,
+	disassembleBytecode: native.disassembleBytecode,
+	disassembleAsync: native.disassembleAsync,
+	disassembleBytecodeAsync: native.disassembleBytecodeAsync,
+	disassembleFile: native.disassembleFile,
+	disassembleFileAsync: native.disassembleFileAsync,
+	disassembleBytecodeStream,
+	decodeBytecode,
+	inspect,
+	disassembleFunction: native.disassembleFunction,
+	controlFlowGraph,
+	exportControlFlowGraph: native.exportControlFlowGraph,
+	disassembleMany: native.disassembleMany,
+	disassembleScripts: native.disassembleScripts,
+	registerEncoding: native.registerEncoding,
+	detectEncoding: native.detectEncoding,
+	configureCache: native.configureCache,
+	cacheStats: native.cacheStats,
+	clearCache: native.clearCache,
+	saveCache: native.saveCache,
+	loadCache: native.loadCache,
+	Disassembler: native.Disassembler,
+};
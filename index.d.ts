@@ -1,11 +1,296 @@
 /// <reference types="node" />
 
-declare function disassemble(script: string): string;
+/** read in place, never copied */
+type BytecodeInput = Buffer | ArrayBuffer | SharedArrayBuffer | ArrayBufferView;
+
+/** thrown (or rejected with) when bytecode can't be read; scripts that don't compile carry the compiler's message */
+interface BytecodeError extends Error {
+	code: "ERR_INVALID_BYTECODE";
+	/** byte offset of the value that failed to read */
+	offset: number;
+	/** part of the format being read, e.g. "strings" or "constants" */
+	section: string;
+	reason: string;
+}
+
+/** "roblox", "auto" to detect the encoding per file, or a name passed to `registerEncoding` */
+type Encoding = "luau" | "roblox" | "auto" | (string & {});
+
+interface DisassembleOptions {
+	encoding?: Encoding;
+	/** format functions on all cores, pays off for bundles with many functions */
+	parallel?: boolean;
+}
+
+declare function disassemble(
+	script: string,
+	options?: DisassembleOptions
+): string;
 declare function disassembleBytecode(
-	bytecode: Buffer,
-	encoding?: "roblox"
+	bytecode: BytecodeInput,
+	options?: Encoding | DisassembleOptions
 ): string;
 
+declare function disassembleAsync(
+	script: string,
+	options?: DisassembleOptions
+): Promise<string>;
+declare function disassembleBytecodeAsync(
+	bytecode: BytecodeInput,
+	options?: Encoding | DisassembleOptions
+): Promise<string>;
+
+/** maps the file and parses it in place, its contents never pass through the JS heap */
+declare function disassembleFile(
+	path: string,
+	options?: Encoding | DisassembleOptions
+): string;
+declare function disassembleFileAsync(
+	path: string,
+	options?: Encoding | DisassembleOptions
+): Promise<string>;
+
+/** streams the listing in chunks as it is produced, without ever holding all of it in memory */
+declare function disassembleBytecodeStream(
+	bytecode: BytecodeInput,
+	options?: Encoding | DisassembleOptions
+): import("stream").Readable;
+
+type DecodedConstant =
+	| { type: "nil"; value: null }
+	| { type: "boolean"; value: boolean }
+	| { type: "number"; value: number }
+	| { type: "vector"; value: [number, number, number, number] }
+	/** index into `strings` */
+	| { type: "string"; value: number }
+	/** resolved path, e.g. ["math", "floor"] */
+	| { type: "import"; value: string[] }
+	| { type: "table"; value: null }
+	/** index into `protos` */
+	| { type: "closure"; value: number };
+
+interface DecodedProto {
+	name: string;
+	lineDefined: number;
+	maxStackSize: number;
+	numParams: number;
+	numUpvalues: number;
+	isVararg: boolean;
+	flags: number;
+
+	/** one entry per instruction; `pc` is the word offset of the instruction, aux words are folded into `aux` */
+	pc: Uint32Array;
+	opcode: Uint8Array;
+	a: Uint8Array;
+	b: Uint8Array;
+	c: Uint8Array;
+	d: Int16Array;
+	aux: Uint32Array;
+	/** `pc` the instruction can jump to, -1 if it doesn't */
+	target: Int32Array;
+
+	constants: DecodedConstant[];
+}
+
+interface DecodedBytecode {
+	version: number;
+	typesVersion: number;
+	mainId: number;
+	/** encoding the opcodes were decoded with, the detected one for "auto" */
+	encoding: string;
+	strings: string[];
+	protos: DecodedProto[];
+}
+
+/** the parsed bytecode as typed arrays instead of text */
+declare function decodeBytecode(
+	bytecode: BytecodeInput,
+	options?: Encoding | DisassembleOptions
+): DecodedBytecode;
+
+interface InspectedProto {
+	name: string;
+	/** byte offset of the proto in the bytecode */
+	offset: number;
+	lineDefined: number;
+	sizeCode: number;
+	constantCount: number;
+}
+
+interface InspectedBytecode {
+	version: number;
+	typesVersion: number;
+	mainId: number;
+	protos: InspectedProto[];
+}
+
+/** where every proto starts and how big it is, from a skim that reads none of them */
+declare function inspect(bytecode: BytecodeInput): InspectedBytecode;
+
+/** the listing of one proto, by index or by the first name matching; only that proto is read */
+declare function disassembleFunction(
+	bytecode: BytecodeInput,
+	proto: number | string,
+	options?: Encoding | DisassembleOptions
+): string;
+
+/**
+ * basic blocks of one proto in code order, block 0 is the entry; the successors of block `i` are
+ * `successors.subarray(successorOffsets[i], successorOffsets[i + 1])`, likewise for predecessors
+ */
+interface ControlFlowGraph {
+	/** pc of the first instruction of every block */
+	blockStart: Uint32Array;
+	/** pc one past the last instruction of every block */
+	blockEnd: Uint32Array;
+	successorOffsets: Uint32Array;
+	successors: Uint32Array;
+	predecessorOffsets: Uint32Array;
+	predecessors: Uint32Array;
+}
+
+/** one graph per proto, in the order of `decodeBytecode(...).protos` */
+declare function controlFlowGraph(
+	bytecode: BytecodeInput,
+	options?: Encoding | DisassembleOptions
+): ControlFlowGraph[];
+
+interface ExportControlFlowGraphOptions extends DisassembleOptions {
+	/** defaults to "dot" */
+	format?: "dot" | "json";
+}
+
+declare function exportControlFlowGraph(
+	bytecode: BytecodeInput,
+	options?: Encoding | ExportControlFlowGraphOptions
+): string;
+
+interface DisassembleManyOptions extends DisassembleOptions {
+	/** called as soon as each result is ready, in completion order; the promise then resolves without a value */
+	onResult?: (result: string | BytecodeError, index: number) => void;
+}
+
+declare function disassembleMany(
+	bytecodes: BytecodeInput[],
+	options?: Encoding | (DisassembleManyOptions & { onResult?: undefined })
+): Promise<(string | BytecodeError)[]>;
+declare function disassembleMany(
+	bytecodes: BytecodeInput[],
+	options: DisassembleManyOptions & { onResult: NonNullable<DisassembleManyOptions["onResult"]> }
+): Promise<void>;
+
+interface CompileOptions {
+	/** 0 to 2, defaults to 1 */
+	optimizationLevel?: 0 | 1 | 2;
+	/** 0 to 2, defaults to 1 */
+	debugLevel?: 0 | 1 | 2;
+	/** library, constructor and type name of vectors, which lets the compiler fold vector constructor calls */
+	vectorLib?: string;
+	vectorCtor?: string;
+	vectorType?: string;
+}
+
+interface DisassembleScriptsOptions extends CompileOptions {
+	parallel?: boolean;
+	/** called as soon as each result is ready, in completion order; the promise then resolves without a value */
+	onResult?: (result: string | BytecodeError, index: number) => void;
+}
+
+/** compiles and disassembles every script on the native thread pool; scripts that don't compile produce an Error in their slot */
+declare function disassembleScripts(
+	scripts: string[],
+	options?: DisassembleScriptsOptions & { onResult?: undefined }
+): Promise<(string | BytecodeError)[]>;
+declare function disassembleScripts(
+	scripts: string[],
+	options: DisassembleScriptsOptions & { onResult: NonNullable<DisassembleScriptsOptions["onResult"]> }
+): Promise<void>;
+
+/**
+ * makes an encoding available by name; `key` is the multiplier that decodes an opcode (odd, 1-255) or a 256 byte
+ * table mapping every encoded opcode to the real one. Throws if the name is taken by a different key
+ */
+declare function registerEncoding(name: string, key: number | Uint8Array): void;
+
+/** name of the registered encoding the bytecode most likely uses */
+declare function detectEncoding(bytecode: BytecodeInput): string;
+
+interface CacheOptions {
+	/** memory the cached listings may take, 0 turns the cache off and empties it */
+	maxBytes?: number;
+	/** memory the compiled bytecode of scripts may take, likewise */
+	compiledMaxBytes?: number;
+}
+
+interface CacheCounters {
+	hits: number;
+	misses: number;
+	evictions: number;
+	entries: number;
+	bytes: number;
+	maxBytes: number;
+}
+
+interface CacheStats extends CacheCounters {
+	/** the cache of compiled scripts */
+	compiled: CacheCounters;
+}
+
+/**
+ * caches bytecode listings by a hash of their input and encoding, and compiled scripts by a hash of their source and
+ * compile options; each is off until given a budget, budgets that aren't given are left as they are
+ */
+declare function configureCache(options: CacheOptions): void;
+declare function cacheStats(): CacheStats;
+declare function clearCache(): void;
+/** writes every cached listing to `path` */
+declare function saveCache(path: string): void;
+/** adds the listings saved in `path` to the cache, returns how many were added (0 if there is no such file) */
+declare function loadCache(path: string): number;
+
+interface DisassemblerOptions {
+	/** memory kept for reuse between calls, anything above this is released before the next call */
+	retainedBytes?: number;
+}
+
+declare class Disassembler {
+	constructor(options?: DisassemblerOptions);
+
+	disassemble(script: string, options?: DisassembleOptions): string;
+	disassembleBytecode(
+		bytecode: BytecodeInput,
+		options?: Encoding | DisassembleOptions
+	): string;
+
+	/** releases all memory held by this context */
+	reset(): void;
+
+	readonly retainedBytes: number;
+}
+
 declare module "simple-luau-disassembler" {
-	export default { disassemble, disassembleBytecode };
+	export default {
+		disassemble,
+		disassembleBytecode,
+		disassembleAsync,
+		disassembleBytecodeAsync,
+		disassembleFile,
+		disassembleFileAsync,
+		disassembleBytecodeStream,
+		decodeBytecode,
+		inspect,
+		disassembleFunction,
+		controlFlowGraph,
+		exportControlFlowGraph,
+		disassembleMany,
+		disassembleScripts,
+		registerEncoding,
+		detectEncoding,
+		configureCache,
+		cacheStats,
+		clearCache,
+		saveCache,
+		loadCache,
+		Disassembler,
+	};
 }
@@ -0,0 +1,74 @@
+#include "analysis.hpp"
+#include "../bytecode/opcodes.hpp"
+
+#include <Luau/BytecodeUtils.h>
+
+void sld::PcSet::reset(uint32_t size)
+{
+  this->size = size;
+  total = 0;
+
+  bits.assign((size_t(size) + 63) / 64, 0);
+  ranks.resize(bits.size());
+}
+
+void sld::PcSet::finish()
+{
+  total = 0;
+
+  for (size_t word = 0; word < bits.size(); ++word)
+  {
+    ranks[word] = total;
+    total += uint32_t(std::bitset<64>(bits[word]).count());
+  }
+}
+
+void sld::find_jump_targets(const Bytecode &bytecode, const Function &function, PcSet &targets)
+{
+  const uint32_t *code = bytecode.code_of(function);
+
+  targets.reset(function.sizecode);
+
+  for (uint32_t pc = 0; pc < function.sizecode;)
+  {
+    targets.insert(jump_target(code[pc], pc));
+    pc += Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc])));
+  }
+
+  targets.finish();
+}
+
+void sld::DecodedFunction::clear()
+{
+  pc.clear();
+  opcode.clear();
+  a.clear();
+  b.clear();
+  c.clear();
+  d.clear();
+  aux.clear();
+  target.clear();
+}
+
+void sld::decode_function(const Bytecode &bytecode, const Function &function, DecodedFunction &result)
+{
+  const uint32_t *code = bytecode.code_of(function);
+
+  for (uint32_t pc = 0; pc < function.sizecode;)
+  {
+    const uint32_t insn = code[pc];
+    const uint8_t op = LUAU_INSN_OP(insn);
+    const bool has_aux = opcodes[op].aux && pc + 1 < function.sizecode;
+
+    result.pc.push_back(pc);
+    result.opcode.push_back(op);
+    result.a.push_back(uint8_t(LUAU_INSN_A(insn)));
+    result.b.push_back(uint8_t(LUAU_INSN_B(insn)));
+    result.c.push_back(uint8_t(LUAU_INSN_C(insn)));
+    result.d.push_back(int16_t(LUAU_INSN_D(insn)));
+    result.aux.push_back(has_aux ? code[pc + 1] : 0);
+    result.target.push_back(jump_target(insn, pc));
+
+    pc += Luau::getOpLength(LuauOpcode(op));
+  }
+}
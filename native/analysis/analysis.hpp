@@ -0,0 +1,147 @@
+#pragma once
+
+#include <Luau/Bytecode.h>
+
+#include <bitset>
+#include <cstdint>
+#include <vector>
+
+#include "../bytecode/bytecode.hpp"
+
+namespace sld
+{
+  // pc of the instruction that the instruction at `pc` can transfer control to, or -1; the same rules as Luau's
+  // BytecodeBuilder uses for labels, so conditional skips and fastcall fallbacks count as jumps as well
+  inline int32_t jump_target(uint32_t insn, uint32_t pc)
+  {
+    switch (LUAU_INSN_OP(insn))
+    {
+    case LOP_JUMP:
+    case LOP_JUMPBACK:
+    case LOP_JUMPIF:
+    case LOP_JUMPIFNOT:
+    case LOP_JUMPIFEQ:
+    case LOP_JUMPIFLE:
+    case LOP_JUMPIFLT:
+    case LOP_JUMPIFNOTEQ:
+    case LOP_JUMPIFNOTLE:
+    case LOP_JUMPIFNOTLT:
+    case LOP_JUMPXEQKNIL:
+    case LOP_JUMPXEQKB:
+    case LOP_JUMPXEQKN:
+    case LOP_JUMPXEQKS:
+    case LOP_FORNPREP:
+    case LOP_FORNLOOP:
+    case LOP_FORGPREP:
+    case LOP_FORGLOOP:
+    case LOP_FORGPREP_INEXT:
+    case LOP_FORGPREP_NEXT:
+      return int32_t(pc) + LUAU_INSN_D(insn) + 1;
+
+    case LOP_FASTCALL:
+    case LOP_FASTCALL1:
+    case LOP_FASTCALL2:
+    case LOP_FASTCALL2K:
+    case LOP_FASTCALL3:
+      return int32_t(pc) + LUAU_INSN_C(insn) + 2;
+
+    case LOP_LOADB:
+      return LUAU_INSN_C(insn) == 0 ? -1 : int32_t(pc) + LUAU_INSN_C(insn) + 1;
+
+    case LOP_JUMPX:
+      return int32_t(pc) + LUAU_INSN_E(insn) + 1;
+
+    default:
+      return -1;
+    }
+  }
+
+  // set of pcs in one function as a bitmap; after finish(), the rank of a member among all members is answered from
+  // per-word running counts. Reusing one instance across functions keeps it free of allocations once it has grown
+  // to the largest function
+  class PcSet
+  {
+  public:
+    // empties the set and sizes it for pcs in [0, size)
+    void reset(uint32_t size);
+
+    // pcs outside the function are ignored
+    void insert(int32_t pc)
+    {
+      if (pc >= 0 && uint32_t(pc) < size)
+        bits[pc >> 6] |= uint64_t(1) << (pc & 63);
+    }
+
+    void erase(uint32_t pc)
+    {
+      if (pc < size)
+        bits[pc >> 6] &= ~(uint64_t(1) << (pc & 63));
+    }
+
+    bool contains(int32_t pc) const
+    {
+      return pc >= 0 && uint32_t(pc) < size && (bits[pc >> 6] >> (pc & 63) & 1) != 0;
+    }
+
+    // computes the running counts, call after the last insert
+    void finish();
+
+    // position of `pc` among all members in pc order, -1 when it isn't one
+    int32_t rank(int32_t pc) const
+    {
+      if (!contains(pc))
+        return -1;
+
+      const uint64_t below = bits[pc >> 6] & ((uint64_t(1) << (pc & 63)) - 1);
+
+      return int32_t(ranks[pc >> 6] + std::bitset<64>(below).count());
+    }
+
+    // number of members, valid after finish()
+    uint32_t count() const
+    {
+      return total;
+    }
+
+    size_t retained_bytes() const
+    {
+      return bits.capacity() * sizeof(uint64_t) + ranks.capacity() * sizeof(uint32_t);
+    }
+
+  private:
+    uint32_t size = 0;
+    uint32_t total = 0;
+
+    std::vector<uint64_t> bits;
+
+    // members in all words before this one
+    std::vector<uint32_t> ranks;
+  };
+
+  // collects every in-range jump target of `function`; a target's label is its rank
+  void find_jump_targets(const Bytecode &bytecode, const Function &function, PcSet &targets);
+
+  // instructions as parallel arrays, one entry per instruction; `pc` is the instruction's word
+  // offset in the function's code, which is also what `target` refers to (-1 when the instruction doesn't jump)
+  struct DecodedFunction
+  {
+    std::vector<uint32_t> pc;
+    std::vector<uint8_t> opcode;
+    std::vector<uint8_t> a;
+    std::vector<uint8_t> b;
+    std::vector<uint8_t> c;
+    std::vector<int16_t> d;
+    std::vector<uint32_t> aux;
+    std::vector<int32_t> target;
+
+    size_t size() const
+    {
+      return pc.size();
+    }
+
+    void clear();
+  };
+
+  // appends to `result`, so the instructions of several functions can be collected into the same arrays
+  void decode_function(const Bytecode &bytecode, const Function &function, DecodedFunction &result);
+}
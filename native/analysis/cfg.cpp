@@ -0,0 +1,283 @@
+#include "cfg.hpp"
+#include "../dumper/dumper.hpp"
+
+#include <Luau/BytecodeUtils.h>
+
+#include <algorithm>
+#include <string>
+#include <string_view>
+
+// control never reaches the next instruction after these
+static bool is_unconditional(uint32_t insn)
+{
+  switch (LUAU_INSN_OP(insn))
+  {
+  case LOP_JUMP:
+  case LOP_JUMPBACK:
+  case LOP_JUMPX:
+  case LOP_FORGPREP:
+  case LOP_FORGPREP_INEXT:
+  case LOP_FORGPREP_NEXT:
+  case LOP_RETURN:
+    return true;
+  case LOP_LOADB:
+    return LUAU_INSN_C(insn) != 0;
+  default:
+    return false;
+  }
+}
+
+void sld::ControlFlowGraph::clear()
+{
+  block_start.clear();
+  block_end.clear();
+  successor_offsets.clear();
+  successors.clear();
+  predecessor_offsets.clear();
+  predecessors.clear();
+}
+
+size_t sld::ControlFlowScratch::retained_bytes() const
+{
+  size_t bytes = leaders.retained_bytes() + targets.retained_bytes() + cursors.capacity() * sizeof(uint32_t) + listing.capacity();
+
+  for (const std::vector<uint32_t> *column : {&graph.block_start, &graph.block_end, &graph.successor_offsets, &graph.successors, &graph.predecessor_offsets, &graph.predecessors})
+    bytes += column->capacity() * sizeof(uint32_t);
+
+  return bytes;
+}
+
+void sld::build_control_flow(const Bytecode &bytecode, const Function &function, ControlFlowScratch &scratch, ControlFlowGraph &result)
+{
+  const uint32_t *code = bytecode.code_of(function);
+  PcSet &leaders = scratch.leaders;
+
+  result.clear();
+
+  if (function.sizecode == 0)
+  {
+    result.successor_offsets.push_back(0);
+    result.predecessor_offsets.push_back(0);
+    return;
+  }
+
+  // a block starts at the entry, at every jump target and after every instruction that can branch
+  leaders.reset(function.sizecode);
+  leaders.insert(0);
+
+  for (uint32_t pc = 0; pc < function.sizecode;)
+  {
+    const uint32_t next = pc + Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc])));
+    const int32_t target = jump_target(code[pc], pc);
+
+    if (target >= 0 || LUAU_INSN_OP(code[pc]) == LOP_RETURN)
+    {
+      leaders.insert(target);
+      leaders.insert(int32_t(next));
+    }
+
+    pc = next;
+  }
+
+  // malformed jumps into an aux word don't start a block, their edges are dropped below
+  for (uint32_t pc = 0; pc < function.sizecode;)
+  {
+    const uint32_t length = Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc])));
+
+    for (uint32_t word = 1; word < length; ++word)
+    {
+      leaders.erase(pc + word);
+    }
+
+    pc += length;
+  }
+
+  leaders.finish();
+
+  // successors of every block, taken from its last instruction
+  result.successor_offsets.push_back(0);
+
+  for (uint32_t pc = 0; pc < function.sizecode;)
+  {
+    const uint32_t next = pc + Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc])));
+
+    if (leaders.contains(int32_t(pc)))
+      result.block_start.push_back(pc);
+
+    if (next >= function.sizecode || leaders.contains(int32_t(next)))
+    {
+      const int32_t target = leaders.rank(jump_target(code[pc], pc));
+      const int32_t fallthrough = is_unconditional(code[pc]) ? -1 : leaders.rank(int32_t(next));
+
+      if (target >= 0)
+        result.successors.push_back(uint32_t(target));
+
+      if (fallthrough >= 0 && fallthrough != target)
+        result.successors.push_back(uint32_t(fallthrough));
+
+      result.block_end.push_back(std::min(next, function.sizecode));
+      result.successor_offsets.push_back(uint32_t(result.successors.size()));
+    }
+
+    pc = next;
+  }
+
+  // predecessors are the transposed edges, laid out with a counting sort
+  const size_t blocks = result.size();
+
+  result.predecessor_offsets.assign(blocks + 1, 0);
+  result.predecessors.resize(result.successors.size());
+
+  for (uint32_t successor : result.successors)
+  {
+    result.predecessor_offsets[successor + 1]++;
+  }
+
+  for (size_t block = 0; block < blocks; ++block)
+  {
+    result.predecessor_offsets[block + 1] += result.predecessor_offsets[block];
+  }
+
+  // next free slot in every block's predecessor list
+  std::vector<uint32_t> &cursors = scratch.cursors;
+  cursors.assign(result.predecessor_offsets.begin(), result.predecessor_offsets.end() - 1);
+
+  for (uint32_t block = 0; block < blocks; ++block)
+  {
+    for (uint32_t edge = result.successor_offsets[block]; edge < result.successor_offsets[block + 1]; ++edge)
+    {
+      result.predecessors[cursors[result.successors[edge]]++] = block;
+    }
+  }
+}
+
+// escapes `text` for a double-quoted DOT or JSON string; DOT wants "\\l" as a left-aligned line break
+static void append_escaped(sld::Writer &result, std::string_view text, std::string_view newline)
+{
+  static constexpr char hex[] = "0123456789abcdef";
+
+  for (char c : text)
+  {
+    if (c == '"' || c == '\\')
+      result.append('\\').append(c);
+    else if (c == '\n')
+      result.append(newline);
+    else if (uint8_t(c) < 0x20)
+      result.append("\\u00").append(hex[uint8_t(c) >> 4]).append(hex[c & 15]);
+    else
+      result.append(c);
+  }
+}
+
+// as listings and both graph exports show it
+static std::string_view function_name(const sld::Function &function)
+{
+  return function.debugname.empty() ? std::string_view("__unnamed_function__") : function.debugname;
+}
+
+void sld::write_control_flow_dot(const Bytecode &bytecode, Writer &result, ControlFlowScratch &scratch)
+{
+  PcSet &targets = scratch.targets;
+  ControlFlowGraph &graph = scratch.graph;
+  std::string &listing = scratch.listing;
+
+  result.append("digraph bytecode {\n  node [shape=box, fontname=monospace];\n");
+
+  for (size_t f = 0; f < bytecode.functions.size(); ++f)
+  {
+    const Function &function = bytecode.functions[f];
+    const uint32_t *code = bytecode.code_of(function);
+
+    build_control_flow(bytecode, function, scratch, graph);
+    find_jump_targets(bytecode, function, targets);
+
+    result.append("  subgraph cluster_").integer(int32_t(f)).append(" {\n    label=\"");
+    append_escaped(result, function_name(function), "\\n");
+    result.append("\";\n");
+
+    for (uint32_t block = 0; block < graph.size(); ++block)
+    {
+      // the block's instructions as they appear in the listing, labels included
+      listing.clear();
+
+      {
+        Writer writer(listing);
+
+        for (uint32_t pc = graph.block_start[block]; pc < graph.block_end[block];)
+        {
+          dumpInstruction(bytecode, function, &code[pc], writer, targets.rank(jump_target(code[pc], pc)), targets.rank(int32_t(pc)));
+          pc += Luau::getOpLength(LuauOpcode(LUAU_INSN_OP(code[pc])));
+        }
+      }
+
+      // every instruction starts with a newline, which becomes the line break after the previous one
+      result.append("    f").integer(int32_t(f)).append('b').integer(int32_t(block)).append(" [label=\"B").integer(int32_t(block));
+      append_escaped(result, listing, "\\l");
+      result.append("\\l\"];\n");
+
+      for (uint32_t edge = graph.successor_offsets[block]; edge < graph.successor_offsets[block + 1]; ++edge)
+      {
+        result.append("    f").integer(int32_t(f)).append('b').integer(int32_t(block));
+        result.append(" -> f").integer(int32_t(f)).append('b').integer(int32_t(graph.successors[edge])).append(";\n");
+      }
+    }
+
+    result.append("  }\n");
+  }
+
+  result.append('}');
+}
+
+static void append_list(sld::Writer &result, const std::vector<uint32_t> &offsets, const std::vector<uint32_t> &values, uint32_t index)
+{
+  result.append('[');
+
+  for (uint32_t i = offsets[index]; i < offsets[index + 1]; ++i)
+  {
+    if (i != offsets[index])
+      result.append(',');
+
+    result.integer(int32_t(values[i]));
+  }
+
+  result.append(']');
+}
+
+void sld::write_control_flow_json(const Bytecode &bytecode, Writer &result, ControlFlowScratch &scratch)
+{
+  ControlFlowGraph &graph = scratch.graph;
+
+  result.append("{\"functions\":[");
+
+  for (size_t f = 0; f < bytecode.functions.size(); ++f)
+  {
+    const Function &function = bytecode.functions[f];
+
+    build_control_flow(bytecode, function, scratch, graph);
+
+    if (f != 0)
+      result.append(',');
+
+    result.append("{\"name\":\"");
+    append_escaped(result, function_name(function), "\\n");
+    result.append("\",\"blocks\":[");
+
+    for (uint32_t block = 0; block < graph.size(); ++block)
+    {
+      if (block != 0)
+        result.append(',');
+
+      result.append("{\"start\":").integer(int32_t(graph.block_start[block]));
+      result.append(",\"end\":").integer(int32_t(graph.block_end[block]));
+      result.append(",\"successors\":");
+      append_list(result, graph.successor_offsets, graph.successors, block);
+      result.append(",\"predecessors\":");
+      append_list(result, graph.predecessor_offsets, graph.predecessors, block);
+      result.append('}');
+    }
+
+    result.append("]}");
+  }
+
+  result.append("]}");
+}
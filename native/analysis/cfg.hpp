@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "../bytecode/bytecode.hpp"
+#include "../dumper/writer.hpp"
+#include "analysis.hpp"
+
+namespace sld
+{
+  // basic blocks of one function with their edges in CSR form: the successors of block i are
+  // successors[successor_offsets[i] .. successor_offsets[i + 1]), likewise for predecessors. Blocks are numbered
+  // in code order, so block 0 is the entry
+  struct ControlFlowGraph
+  {
+    // pc of the first instruction and one past the last word of every block
+    std::vector<uint32_t> block_start;
+    std::vector<uint32_t> block_end;
+
+    std::vector<uint32_t> successor_offsets;
+    std::vector<uint32_t> successors;
+
+    std::vector<uint32_t> predecessor_offsets;
+    std::vector<uint32_t> predecessors;
+
+    size_t size() const
+    {
+      return block_start.size();
+    }
+
+    void clear();
+  };
+
+  // what building and exporting graphs reuses from one function to the next, to keep repeated builds free of
+  // allocations; a Disassembler keeps one, so its retained-bytes limit and reset() cover it
+  struct ControlFlowScratch
+  {
+    PcSet leaders;
+    PcSet targets;
+    std::vector<uint32_t> cursors;
+    ControlFlowGraph graph;
+    std::string listing;
+
+    size_t retained_bytes() const;
+  };
+
+  void build_control_flow(const Bytecode &bytecode, const Function &function, ControlFlowScratch &scratch, ControlFlowGraph &result);
+
+  // every function's graph as a DOT digraph with one cluster per function, blocks list their instructions
+  void write_control_flow_dot(const Bytecode &bytecode, Writer &result, ControlFlowScratch &scratch);
+
+  // every function's graph as {"functions": [{"name", "blocks": [{"start", "end", "successors", "predecessors"}]}]}
+  void write_control_flow_json(const Bytecode &bytecode, Writer &result, ControlFlowScratch &scratch);
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace sld
+{
+  // how the opcode byte of every instruction is stored; ids past Roblox belong to schemes registered at runtime,
+  // see encoding.hpp
+  enum BytecodeEncoding : uint8_t
+  {
+    Luau,
+    Roblox,
+
+    // picked per blob by sampling the first instructions of every function
+    Auto = 0xff,
+  };
+
+  struct Constant
+  {
+    enum Type
+    {
+      Type_Nil,
+      Type_Boolean,
+      Type_Number,
+      Type_Vector,
+      Type_String,
+      Type_Import,
+      Type_Table,
+      Type_Closure,
+    };
+
+    Type type;
+    union
+    {
+      bool valueBoolean;
+      double valueNumber;
+      float valueVector[4];
+      unsigned int valueString; // index into string table
+      uint32_t valueImport;     // 10-10-10-2 encoded import id
+      uint32_t valueTable;      // index into tableShapes[]
+      uint32_t valueClosure;    // index of function in global list
+    };
+  };
+
+  // a function prototype as laid out in the bytecode; code and constants are ranges into the flat arrays owned by Bytecode
+  struct Function
+  {
+    uint8_t maxstacksize;
+    uint8_t numparams;
+    uint8_t nups;
+    uint8_t is_vararg;
+    uint8_t flags;
+
+    uint32_t linedefined;
+    std::string_view debugname;
+
+    uint32_t code_start;
+    uint32_t sizecode;
+
+    uint32_t constants_start;
+    uint32_t sizek;
+  };
+
+  // a proto as found by inspect_bytecode, without its code or constants
+  struct ProtoInfo
+  {
+    // byte offset of the proto in the input
+    size_t offset;
+
+    uint32_t linedefined;
+    std::string_view debugname;
+
+    uint32_t sizecode;
+    uint32_t sizek;
+  };
+
+  // where and why reading a bytecode blob failed
+  struct BytecodeError
+  {
+    // byte offset into the input of the value that failed to read
+    size_t offset = 0;
+
+    // part of the format being read, e.g. "strings" or "constants"
+    std::string_view section;
+    std::string_view reason;
+
+    // the compiler's message when the blob holds a compilation error instead of code
+    std::string detail;
+  };
+
+  // allocation-light view of a bytecode blob; strings point into the input buffer, so it must outlive this object.
+  // `code` ends in a zero word past the last function, so reading an instruction's aux word never leaves the array
+  struct Bytecode
+  {
+    uint8_t version = 0;
+    uint8_t typesversion = 0;
+    uint32_t mainid = 0;
+
+    // scheme the opcodes were decoded with, never Auto
+    BytecodeEncoding encoding = BytecodeEncoding::Luau;
+
+    std::vector<std::string_view> strings;
+    std::vector<Function> functions;
+    std::vector<Constant> constants;
+    std::vector<uint32_t> code;
+
+    // 1-based string id as stored in the bytecode, 0 is the null string
+    std::string_view string(unsigned int id) const
+    {
+      return id == 0 || id > strings.size() ? std::string_view{} : strings[id - 1];
+    }
+
+    const uint32_t *code_of(const Function &function) const
+    {
+      return code.data() + function.code_start;
+    }
+
+    const Constant *constants_of(const Function &function) const
+    {
+      return constants.data() + function.constants_start;
+    }
+
+    // keeps capacity so that a reused Bytecode does not reallocate for similarly sized inputs
+    void clear()
+    {
+      version = 0;
+      typesversion = 0;
+      mainid = 0;
+      encoding = BytecodeEncoding::Luau;
+
+      strings.clear();
+      functions.clear();
+      constants.clear();
+      code.clear();
+    }
+
+    // frees the backing storage as well
+    void release()
+    {
+      clear();
+
+      decltype(strings)().swap(strings);
+      decltype(functions)().swap(functions);
+      decltype(constants)().swap(constants);
+      decltype(code)().swap(code);
+    }
+  };
+
+  // what a skim over a bytecode blob finds: its header, string table and where every proto starts. Like Bytecode,
+  // the strings point into the input buffer
+  struct BytecodeIndex
+  {
+    uint8_t version = 0;
+    uint8_t typesversion = 0;
+    uint32_t mainid = 0;
+
+    std::vector<std::string_view> strings;
+    std::vector<ProtoInfo> protos;
+
+    std::string_view string(unsigned int id) const
+    {
+      return id == 0 || id > strings.size() ? std::string_view{} : strings[id - 1];
+    }
+
+    // first proto named `name`
+    std::optional<uint32_t> find(std::string_view name) const
+    {
+      for (size_t i = 0; i < protos.size(); ++i)
+      {
+        if (protos[i].debugname == name)
+          return uint32_t(i);
+      }
+
+      return {};
+    }
+
+    void clear()
+    {
+      version = 0;
+      typesversion = 0;
+      mainid = 0;
+
+      strings.clear();
+      protos.clear();
+    }
+
+    void release()
+    {
+      clear();
+
+      decltype(strings)().swap(strings);
+      decltype(protos)().swap(protos);
+    }
+  };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <Luau/Bytecode.h>
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace sld
+{
+  // how a single operand is printed; everything but Operand::None is preceded by a space
+  enum class Operand : uint8_t
+  {
+    None,
+
+    RegA,       // R<A>
+    RegB,       // R<B>
+    RegC,       // R<C>
+    RegAux,     // R<aux>
+    RegAuxPair, // R<aux & 0xff> R<(aux >> 8) & 0xff>
+
+    A,         // <A>
+    B,         // <B>
+    D,         // <D>
+    Aux,       // <aux>
+    BMinusOne, // <B - 1>, counts biased by one so that 0 means "multiple"
+    CMinusOne, // <C - 1>
+    CPlusOne,  // <C + 1>, GETTABLEN/SETTABLEN store the index minus one
+    TableSize, // hash size encoded as log2 + 1 in B
+    AuxBool,   // <aux & 1>
+    AuxByte,   // <uint8_t(aux)>
+
+    ConstantB,         // K<B> [constant]
+    ConstantC,         // K<C>, constant printed at the end of the line
+    ConstantD,         // K<D>, constant printed at the end of the line
+    ConstantAux,       // K<aux>, constant printed at the end of the line
+    ConstantAuxLow,    // K<aux & 0xffffff>, constant printed at the end of the line
+    ImportD,           // <D>, import constant printed at the end of the line
+    ProtoD,            // P<D>
+    Label,             // L<target label>
+    SkipC,             // +<C> when C is non-zero
+    AuxNot,            // NOT when the high bit of aux is set
+    AuxInext,          // [inext] when aux is negative
+    AuxList,           // [<aux>]
+    Capture,           // VAL/REF/UPVAL followed by R<B> or U<B>
+  };
+
+  constexpr size_t max_operands = 4;
+
+  struct OpcodeInfo
+  {
+    std::string_view name;
+    std::array<Operand, max_operands> operands;
+
+    // whether the instruction is followed by an auxiliary word
+    bool aux;
+
+    // constant printed in brackets after all operands, if any
+    constexpr bool trailing_constant() const
+    {
+      for (auto operand : operands)
+      {
+        switch (operand)
+        {
+        case Operand::ConstantC:
+        case Operand::ConstantD:
+        case Operand::ConstantAux:
+        case Operand::ConstantAuxLow:
+        case Operand::ImportD:
+          return true;
+        default:
+          break;
+        }
+      }
+
+      return false;
+    }
+  };
+
+  // indexed by LuauOpcode, unnamed entries are opcodes that are never printed (deprecated ones and anything past LOP__COUNT)
+  inline constexpr std::array<OpcodeInfo, 256> opcodes = []()
+  {
+    using O = Operand;
+
+    std::array<OpcodeInfo, 256> table{};
+
+    table[LOP_NOP] = {"NOP", {}, false};
+    table[LOP_BREAK] = {"BREAK", {}, false};
+    table[LOP_LOADNIL] = {"LOADNIL", {O::RegA}, false};
+    table[LOP_LOADB] = {"LOADB", {O::RegA, O::B, O::SkipC}, false};
+    table[LOP_LOADN] = {"LOADN", {O::RegA, O::D}, false};
+    table[LOP_LOADK] = {"LOADK", {O::RegA, O::ConstantD}, false};
+    table[LOP_MOVE] = {"MOVE", {O::RegA, O::RegB}, false};
+    table[LOP_GETGLOBAL] = {"GETGLOBAL", {O::RegA, O::ConstantAux}, true};
+    table[LOP_SETGLOBAL] = {"SETGLOBAL", {O::RegA, O::ConstantAux}, true};
+    table[LOP_GETUPVAL] = {"GETUPVAL", {O::RegA, O::B}, false};
+    table[LOP_SETUPVAL] = {"SETUPVAL", {O::RegA, O::B}, false};
+    table[LOP_CLOSEUPVALS] = {"CLOSEUPVALS", {O::RegA}, false};
+    table[LOP_GETIMPORT] = {"GETIMPORT", {O::RegA, O::ImportD}, true};
+    table[LOP_GETTABLE] = {"GETTABLE", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_SETTABLE] = {"SETTABLE", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_GETTABLEKS] = {"GETTABLEKS", {O::RegA, O::RegB, O::ConstantAux}, true};
+    table[LOP_SETTABLEKS] = {"SETTABLEKS", {O::RegA, O::RegB, O::ConstantAux}, true};
+    table[LOP_GETTABLEN] = {"GETTABLEN", {O::RegA, O::RegB, O::CPlusOne}, false};
+    table[LOP_SETTABLEN] = {"SETTABLEN", {O::RegA, O::RegB, O::CPlusOne}, false};
+    table[LOP_NEWCLOSURE] = {"NEWCLOSURE", {O::RegA, O::ProtoD}, false};
+    table[LOP_NAMECALL] = {"NAMECALL", {O::RegA, O::RegB, O::ConstantAux}, true};
+    table[LOP_CALL] = {"CALL", {O::RegA, O::BMinusOne, O::CMinusOne}, false};
+    table[LOP_RETURN] = {"RETURN", {O::RegA, O::BMinusOne}, false};
+    table[LOP_JUMP] = {"JUMP", {O::Label}, false};
+    table[LOP_JUMPBACK] = {"JUMPBACK", {O::Label}, false};
+    table[LOP_JUMPIF] = {"JUMPIF", {O::RegA, O::Label}, false};
+    table[LOP_JUMPIFNOT] = {"JUMPIFNOT", {O::RegA, O::Label}, false};
+    table[LOP_JUMPIFEQ] = {"JUMPIFEQ", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_JUMPIFLE] = {"JUMPIFLE", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_JUMPIFLT] = {"JUMPIFLT", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_JUMPIFNOTEQ] = {"JUMPIFNOTEQ", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_JUMPIFNOTLE] = {"JUMPIFNOTLE", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_JUMPIFNOTLT] = {"JUMPIFNOTLT", {O::RegA, O::RegAux, O::Label}, true};
+    table[LOP_ADD] = {"ADD", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_SUB] = {"SUB", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_MUL] = {"MUL", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_DIV] = {"DIV", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_IDIV] = {"IDIV", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_MOD] = {"MOD", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_POW] = {"POW", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_ADDK] = {"ADDK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_SUBK] = {"SUBK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_MULK] = {"MULK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_DIVK] = {"DIVK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_IDIVK] = {"IDIVK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_MODK] = {"MODK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_POWK] = {"POWK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_SUBRK] = {"SUBRK", {O::RegA, O::ConstantB, O::RegC}, false};
+    table[LOP_DIVRK] = {"DIVRK", {O::RegA, O::ConstantB, O::RegC}, false};
+    table[LOP_AND] = {"AND", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_OR] = {"OR", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_ANDK] = {"ANDK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_ORK] = {"ORK", {O::RegA, O::RegB, O::ConstantC}, false};
+    table[LOP_CONCAT] = {"CONCAT", {O::RegA, O::RegB, O::RegC}, false};
+    table[LOP_NOT] = {"NOT", {O::RegA, O::RegB}, false};
+    table[LOP_MINUS] = {"MINUS", {O::RegA, O::RegB}, false};
+    table[LOP_LENGTH] = {"LENGTH", {O::RegA, O::RegB}, false};
+    table[LOP_NEWTABLE] = {"NEWTABLE", {O::RegA, O::TableSize, O::Aux}, true};
+    table[LOP_DUPTABLE] = {"DUPTABLE", {O::RegA, O::D}, false};
+    table[LOP_SETLIST] = {"SETLIST", {O::RegA, O::RegB, O::CMinusOne, O::AuxList}, true};
+    table[LOP_FORNPREP] = {"FORNPREP", {O::RegA, O::Label}, false};
+    table[LOP_FORNLOOP] = {"FORNLOOP", {O::RegA, O::Label}, false};
+    table[LOP_FORGPREP] = {"FORGPREP", {O::RegA, O::Label}, false};
+    table[LOP_FORGLOOP] = {"FORGLOOP", {O::RegA, O::Label, O::AuxByte, O::AuxInext}, true};
+    table[LOP_FORGPREP_INEXT] = {"FORGPREP_INEXT", {O::RegA, O::Label}, false};
+    table[LOP_FORGPREP_NEXT] = {"FORGPREP_NEXT", {O::RegA, O::Label}, false};
+    table[LOP_GETVARARGS] = {"GETVARARGS", {O::RegA, O::BMinusOne}, false};
+    table[LOP_DUPCLOSURE] = {"DUPCLOSURE", {O::RegA, O::ConstantD}, false};
+    table[LOP_PREPVARARGS] = {"PREPVARARGS", {O::RegA}, false};
+    table[LOP_LOADKX] = {"LOADKX", {O::RegA, O::ConstantAux}, true};
+    table[LOP_JUMPX] = {"JUMPX", {O::Label}, false};
+    table[LOP_FASTCALL] = {"FASTCALL", {O::A, O::Label}, false};
+    table[LOP_FASTCALL1] = {"FASTCALL1", {O::A, O::RegB, O::Label}, false};
+    table[LOP_FASTCALL2] = {"FASTCALL2", {O::A, O::RegB, O::RegAux, O::Label}, true};
+    table[LOP_FASTCALL2K] = {"FASTCALL2K", {O::A, O::RegB, O::ConstantAux, O::Label}, true};
+    table[LOP_FASTCALL3] = {"FASTCALL3", {O::A, O::RegB, O::RegAuxPair, O::Label}, true};
+    table[LOP_COVERAGE] = {"COVERAGE", {}, false};
+    table[LOP_CAPTURE] = {"CAPTURE", {O::Capture}, false};
+    table[LOP_JUMPXEQKNIL] = {"JUMPXEQKNIL", {O::RegA, O::Label, O::AuxNot}, true};
+    table[LOP_JUMPXEQKB] = {"JUMPXEQKB", {O::RegA, O::AuxBool, O::Label, O::AuxNot}, true};
+    table[LOP_JUMPXEQKN] = {"JUMPXEQKN", {O::RegA, O::ConstantAuxLow, O::Label, O::AuxNot}, true};
+    table[LOP_JUMPXEQKS] = {"JUMPXEQKS", {O::RegA, O::ConstantAuxLow, O::Label, O::AuxNot}, true};
+
+    return table;
+  }();
+}
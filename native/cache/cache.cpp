@@ -0,0 +1,259 @@
+#include "cache.hpp"
+#include "hash.hpp"
+#include "../encoding/encoding.hpp"
+#include "../io/mapped_file.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+
+// bookkeeping charged to every entry on top of its text and input: list node, index slot and the shared string
+static constexpr size_t entry_overhead = 128;
+
+// "SLDCACHE" followed by the format version
+static constexpr char file_magic[8] = {'S', 'L', 'D', 'C', 'A', 'C', 'H', 'E'};
+static constexpr uint32_t file_version = 3;
+
+sld::ResultCache &sld::ResultCache::shared()
+{
+  static ResultCache cache;
+  return cache;
+}
+
+sld::ResultCache &sld::ResultCache::compiled()
+{
+  static ResultCache cache;
+  return cache;
+}
+
+sld::CacheKey sld::ResultCache::key(std::string_view input, BytecodeEncoding encoding)
+{
+  EncodingIdentity identity = encoding_identity(encoding);
+  const uint64_t hash = hash_bytes(input, hash_bytes(identity.key));
+
+  return {hash, input.size(), std::move(identity.key), identity.portable};
+}
+
+sld::CacheKey sld::ResultCache::key(std::string_view script, const CompileOptions &options)
+{
+  std::string settings;
+  settings.push_back(char('0' + options.optimization_level));
+  settings.push_back(char('0' + options.debug_level));
+
+  // names can't hold a null character, which keeps "ab" + "c" apart from "a" + "bc"
+  for (const std::string *name : {&options.vector_lib, &options.vector_ctor, &options.vector_type})
+  {
+    settings.push_back('\0');
+    settings.append(*name);
+  }
+
+  const uint64_t hash = hash_bytes(script, hash_bytes(settings));
+  return {hash, script.size(), std::move(settings)};
+}
+
+size_t sld::ResultCache::Entry::cost() const
+{
+  return listing->size() + input.size() + key.settings.size() + entry_overhead;
+}
+
+void sld::ResultCache::set_budget(size_t limit)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  budget = limit;
+  evict_locked(limit);
+}
+
+std::shared_ptr<const std::string> sld::ResultCache::find(const CacheKey &key, std::string_view input)
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  const auto it = index.find(key);
+
+  // a different input with the same hash and size is a miss like any other
+  if (it == index.end() || it->second->input != input)
+  {
+    misses++;
+    return nullptr;
+  }
+
+  hits++;
+  entries.splice(entries.begin(), entries, it->second);
+
+  return it->second->listing;
+}
+
+void sld::ResultCache::insert(const CacheKey &key, std::string_view input, std::string_view listing)
+{
+  // an entry that can't fit is not worth copying
+  if (listing.size() + input.size() + key.settings.size() + entry_overhead > budget)
+    return;
+
+  Entry entry{key, std::string(input), std::make_shared<const std::string>(listing)};
+
+  std::lock_guard<std::mutex> lock(mutex);
+  insert_locked(std::move(entry));
+}
+
+bool sld::ResultCache::insert_locked(Entry entry)
+{
+  const size_t cost = entry.cost();
+
+  if (cost > budget)
+    return false;
+
+  const auto existing = index.find(entry.key);
+
+  // two threads missed on the same input at once, the first listing stays; so does the first of two inputs whose
+  // hashes collide
+  if (existing != index.end())
+  {
+    entries.splice(entries.begin(), entries, existing->second);
+    return existing->second->input == entry.input;
+  }
+
+  evict_locked(budget - cost);
+
+  entries.push_front(std::move(entry));
+  index.emplace(entries.front().key, entries.begin());
+  bytes += cost;
+
+  return true;
+}
+
+void sld::ResultCache::evict_locked(size_t limit)
+{
+  while (bytes > limit && !entries.empty())
+  {
+    const Entry &oldest = entries.back();
+
+    bytes -= oldest.cost();
+    index.erase(oldest.key);
+    entries.pop_back();
+
+    evictions++;
+  }
+}
+
+void sld::ResultCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  entries.clear();
+  index.clear();
+  bytes = 0;
+}
+
+sld::CacheStats sld::ResultCache::stats()
+{
+  std::lock_guard<std::mutex> lock(mutex);
+
+  CacheStats stats;
+  stats.hits = hits;
+  stats.misses = misses;
+  stats.evictions = evictions;
+  stats.entries = entries.size();
+  stats.bytes = bytes;
+  stats.budget = budget;
+
+  return stats;
+}
+
+bool sld::ResultCache::save(const std::string &path)
+{
+  // written next to the target and moved over it, so a crash never leaves a truncated cache behind
+  const std::string temporary = path + ".tmp";
+  FILE *file = fopen(temporary.c_str(), "wb");
+
+  if (file == nullptr)
+    return false;
+
+  bool ok = fwrite(file_magic, sizeof(file_magic), 1, file) == 1 && fwrite(&file_version, sizeof(file_version), 1, file) == 1;
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // every entry is its hash and the sizes of its settings, input and listing, followed by the three of them
+    for (auto it = entries.rbegin(); ok && it != entries.rend(); ++it)
+    {
+      if (!it->key.portable)
+        continue;
+
+      const uint64_t header[4] = {it->key.hash, it->key.settings.size(), it->input.size(), it->listing->size()};
+
+      ok = fwrite(header, sizeof(header), 1, file) == 1;
+
+      for (std::string_view text : {std::string_view(it->key.settings), std::string_view(it->input), std::string_view(*it->listing)})
+        ok = ok && fwrite(text.data(), 1, text.size(), file) == text.size();
+    }
+  }
+
+  ok = fclose(file) == 0 && ok;
+
+  std::error_code error;
+
+  if (ok)
+    std::filesystem::rename(temporary, path, error);
+
+  if (!ok || error)
+  {
+    std::filesystem::remove(temporary, error);
+    return false;
+  }
+
+  return true;
+}
+
+int64_t sld::ResultCache::load(const std::string &path)
+{
+  MappedFile file;
+
+  if (!file.open(path))
+    return -1;
+
+  const std::string_view data = file.view();
+  constexpr size_t header_size = sizeof(file_magic) + sizeof(file_version);
+
+  uint32_t version = 0;
+
+  if (data.size() < header_size || memcmp(data.data(), file_magic, sizeof(file_magic)) != 0)
+    return -1;
+
+  memcpy(&version, data.data() + sizeof(file_magic), sizeof(version));
+
+  if (version != file_version)
+    return -1;
+
+  int64_t loaded = 0;
+  size_t offset = header_size;
+
+  std::lock_guard<std::mutex> lock(mutex);
+
+  // a truncated tail keeps whatever was complete before it
+  while (data.size() - offset >= 4 * sizeof(uint64_t))
+  {
+    uint64_t header[4];
+    memcpy(header, data.data() + offset, sizeof(header));
+    offset += sizeof(header);
+
+    const uint64_t left = data.size() - offset;
+
+    // checked one at a time, so the sum can't overflow
+    if (header[1] > left || header[2] > left - header[1] || header[3] > left - header[1] - header[2])
+      break;
+
+    const std::string_view settings = data.substr(offset, size_t(header[1]));
+    const std::string_view input = data.substr(offset + settings.size(), size_t(header[2]));
+    const std::string_view listing = data.substr(offset + settings.size() + input.size(), size_t(header[3]));
+
+    // the hash is only trusted for the index, the stored input is what a hit is confirmed against
+    CacheKey key{header[0], input.size(), std::string(settings)};
+
+    if (insert_locked({std::move(key), std::string(input), std::make_shared<const std::string>(listing)}))
+      loaded++;
+
+    offset += settings.size() + input.size() + listing.size();
+  }
+
+  return loaded;
+}
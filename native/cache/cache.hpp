@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../bytecode/bytecode.hpp"
+#include "../disassembler/disassembler.hpp"
+
+namespace sld
+{
+  // identifies an input together with the options that affect its listing; the settings are kept as they are,
+  // the input only by its hash and size, so a hit is confirmed against the input stored with the entry
+  struct CacheKey
+  {
+    uint64_t hash = 0;
+    uint64_t size = 0;
+    std::string settings;
+
+    // whether the settings mean the same in another process, only entries that do are saved
+    bool portable = true;
+
+    bool operator==(const CacheKey &other) const
+    {
+      return hash == other.hash && size == other.size && settings == other.settings;
+    }
+  };
+
+  struct CacheStats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+
+    size_t entries = 0;
+    size_t bytes = 0;
+    size_t budget = 0;
+  };
+
+  // least recently used listings (or compiled scripts) keyed by a hash of their input; disabled (and free to ask)
+  // until it's given a budget. Every entry keeps a copy of its input, which a hit has to match byte for byte and
+  // which counts against the budget. Entries are shared, so a hit copies the listing without holding the lock
+  class ResultCache
+  {
+  public:
+    // the cache the disassembler consults, off by default
+    static ResultCache &shared();
+    // bytecode of the scripts the disassembler compiled, off by default; their listings go through shared()
+    static ResultCache &compiled();
+
+    bool enabled() const
+    {
+      return budget != 0;
+    }
+
+    // evicts down to the new budget right away; 0 turns the cache off and empties it
+    void set_budget(size_t bytes);
+
+    // the encoding goes into the key by what it decodes to rather than by name, so a name registered differently in
+    // another process (or Auto after a registration) doesn't share listings
+    static CacheKey key(std::string_view input, BytecodeEncoding encoding);
+    // likewise every compiler setting goes into the hash of a script
+    static CacheKey key(std::string_view script, const CompileOptions &options);
+
+    // the cached listing of `input`, or null (counted as a miss) if there is none
+    std::shared_ptr<const std::string> find(const CacheKey &key, std::string_view input);
+    void insert(const CacheKey &key, std::string_view input, std::string_view listing);
+
+    void clear();
+    CacheStats stats();
+
+    // writes every portable entry to `path`, least recently used first; false if the file couldn't be written
+    bool save(const std::string &path);
+    // adds the entries stored in `path` as the most recently used ones, as far as the budget allows; the number of
+    // entries added, or -1 if the file couldn't be read or isn't a cache file
+    int64_t load(const std::string &path);
+
+  private:
+    struct KeyHash
+    {
+      size_t operator()(const CacheKey &key) const
+      {
+        return size_t(key.hash);
+      }
+    };
+
+    struct Entry
+    {
+      CacheKey key;
+      std::string input;
+      std::shared_ptr<const std::string> listing;
+
+      size_t cost() const;
+    };
+
+    // false if the entry doesn't fit the budget
+    bool insert_locked(Entry entry);
+    void evict_locked(size_t limit);
+
+    std::mutex mutex;
+
+    // front is the most recently used
+    std::list<Entry> entries;
+    std::unordered_map<CacheKey, std::list<Entry>::iterator, KeyHash> index;
+
+    // read without the lock by enabled(), a stale value only costs one lookup more or less
+    std::atomic<size_t> budget{0};
+    size_t bytes = 0;
+
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+    uint64_t evictions = 0;
+  };
+}
@@ -0,0 +1,102 @@
+#include "hash.hpp"
+
+#include <cstring>
+
+static constexpr uint64_t prime1 = 0x9E3779B185EBCA87ull;
+static constexpr uint64_t prime2 = 0xC2B2AE3D27D4EB4Full;
+static constexpr uint64_t prime3 = 0x165667B19E3779F9ull;
+static constexpr uint64_t prime4 = 0x85EBCA77C2B2AE63ull;
+static constexpr uint64_t prime5 = 0x27D4EB2F165667C5ull;
+
+static inline uint64_t rotate_left(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+// inputs are read as little-endian words, which is what every supported platform is
+static inline uint64_t read64(const char *data)
+{
+  uint64_t value;
+  memcpy(&value, data, sizeof(value));
+
+  return value;
+}
+
+static inline uint32_t read32(const char *data)
+{
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+
+  return value;
+}
+
+static inline uint64_t round(uint64_t accumulator, uint64_t input)
+{
+  return rotate_left(accumulator + input * prime2, 31) * prime1;
+}
+
+static inline uint64_t merge_round(uint64_t hash, uint64_t accumulator)
+{
+  return (hash ^ round(0, accumulator)) * prime1 + prime4;
+}
+
+uint64_t sld::hash_bytes(std::string_view data, uint64_t seed)
+{
+  const char *p = data.data();
+  const char *const end = p + data.size();
+
+  uint64_t hash;
+
+  if (data.size() >= 32)
+  {
+    uint64_t v1 = seed + prime1 + prime2;
+    uint64_t v2 = seed + prime2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - prime1;
+
+    // four independent lanes over 32 byte stripes
+    for (; end - p >= 32; p += 32)
+    {
+      v1 = round(v1, read64(p));
+      v2 = round(v2, read64(p + 8));
+      v3 = round(v3, read64(p + 16));
+      v4 = round(v4, read64(p + 24));
+    }
+
+    hash = rotate_left(v1, 1) + rotate_left(v2, 7) + rotate_left(v3, 12) + rotate_left(v4, 18);
+    hash = merge_round(hash, v1);
+    hash = merge_round(hash, v2);
+    hash = merge_round(hash, v3);
+    hash = merge_round(hash, v4);
+  }
+  else
+  {
+    hash = seed + prime5;
+  }
+
+  hash += data.size();
+
+  for (; end - p >= 8; p += 8)
+  {
+    hash = rotate_left(hash ^ round(0, read64(p)), 27) * prime1 + prime4;
+  }
+
+  if (end - p >= 4)
+  {
+    hash = rotate_left(hash ^ (read32(p) * prime1), 23) * prime2 + prime3;
+    p += 4;
+  }
+
+  for (; p < end; ++p)
+  {
+    hash = rotate_left(hash ^ (uint8_t(*p) * prime5), 11) * prime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= prime2;
+  hash ^= hash >> 29;
+  hash *= prime3;
+  hash ^= hash >> 32;
+
+  return hash;
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace sld
+{
+  // XXH64 of `data`; fast enough to run over every input, and stable across runs so that hashes can be stored
+  uint64_t hash_bytes(std::string_view data, uint64_t seed = 0);
+}
@@ -1,538 +1,815 @@
 #include "../dumper/dumper.hpp"
 #include "../deserializer/deserializer.hpp"
-
-#include <lobject.h>
-#include <lvm.h>
-#include <ldo.h>
-#include <lgc.h>
-#include <lmem.h>
-#include <lfunc.h>
-#include <lstring.h>
-#include <lapi.h>
-#include <ltable.h>
-#include <lualib.h>
+#include "../encoding/encoding.hpp"
 
 #include <Luau/Bytecode.h>
-#include <Luau/BytecodeUtils.h>
 
-#include <cstring>
 #include <algorithm>
-#include <vector>
-#include <format>
+#include <cstring>
+#include <iterator>
 
-using sld::Constant, sld::TempBuffer;
+using sld::Bytecode, sld::Constant, sld::Function;
 
-template <typename T>
-static T read(const char *data, size_t size, size_t &offset)
+// cursor over the input that validates extents once per section and reads unchecked inside them; the first failure
+// is recorded in `error` and every check after it fails too, so callers can bail out at their own pace
+class Reader
 {
-  T result;
-  memcpy(&result, data + offset, sizeof(T));
-  offset += sizeof(T);
-
-  return result;
-}
+public:
+  Reader(std::string_view input, sld::BytecodeError &error)
+      : data(input.data()), size(input.size()), error(error)
+  {
+  }
 
-static unsigned int readVarInt(const char *data, size_t size, size_t &offset)
-{
-  unsigned int result = 0;
-  unsigned int shift = 0;
+  // marks where subsequent failures are reported
+  void enter(const char *name)
+  {
+    section = name;
+  }
 
-  uint8_t byte;
+  bool fail(const char *reason)
+  {
+    return fail_at(offset, reason);
+  }
 
-  do
+  bool fail_at(size_t at, const char *reason)
   {
-    byte = read<uint8_t>(data, size, offset);
+    if (!failed)
+    {
+      failed = true;
+      error.offset = at;
+      error.section = section;
+      error.reason = reason;
+      error.detail.clear();
+    }
 
-    result |= (byte & 127) << shift;
+    return false;
+  }
 
-    shift += 7;
+  bool ok() const
+  {
+    return !failed;
+  }
 
-  } while (byte & 128);
+  size_t position() const
+  {
+    return offset;
+  }
 
-  return result;
-}
+  // checks that `count` more bytes exist, reads within them don't need their own check
+  bool require(size_t count)
+  {
+    return !failed && (count <= size - offset || fail("unexpected end of data"));
+  }
 
-static TString *readString(TempBuffer<TString *> &strings, const char *data, size_t size, size_t &offset)
-{
-  unsigned int id = readVarInt(data, size, offset);
+  template <typename T>
+  T read_unchecked()
+  {
+    T result;
+    memcpy(&result, data + offset, sizeof(T));
+    offset += sizeof(T);
 
-  return id == 0 ? NULL : strings[id - 1];
-}
+    return result;
+  }
 
-static void resolveImportSafe(lua_State *L, Table *env, TValue *k, uint32_t id)
-{
-  struct ResolveImport
+  template <typename T>
+  T read()
   {
-    TValue *k;
-    uint32_t id;
-
-    static void run(lua_State *L, void *ud)
-    {
-      ResolveImport *self = static_cast<ResolveImport *>(ud);
+    return require(sizeof(T)) ? read_unchecked<T>() : T{};
+  }
 
-      // note: we call getimport with nil propagation which means that accesses to table chains like A.B.C will resolve in nil
-      // this is technically not necessary but it reduces the number of exceptions when loading scripts that rely on getfenv/setfenv for global
-      // injection
-      // allocate a stack slot so that we can do table lookups
-      luaD_checkstack(L, 1);
-      setnilvalue(L->top);
-      L->top++;
+  // almost every varint in practice is a single byte, longer ones take the checked loop
+  uint32_t varint()
+  {
+    if (offset < size && uint8_t(data[offset]) < 128)
+      return uint8_t(data[offset++]);
 
-      luaV_getimport(L, L->gt, self->k, L->top - 1, self->id, /* propagatenil= */ true);
-    }
-  };
+    return varint_slow();
+  }
 
-  ResolveImport ri = {k, id};
-  if (L->gt->safeenv)
+  const char *bytes(size_t count)
   {
-    // luaD_pcall will make sure that if any C/Lua calls during import resolution fail, the thread state is restored back
-    int oldTop = lua_gettop(L);
-    int status = luaD_pcall(L, &ResolveImport::run, &ri, savestack(L, L->top), 0);
-    LUAU_ASSERT(oldTop + 1 == lua_gettop(L)); // if an error occurred, luaD_pcall saves it on stack
+    if (!require(count))
+      return nullptr;
 
-    if (status != 0)
-    {
-      // replace error object with nil
-      setnilvalue(L->top - 1);
-    }
+    const char *result = data + offset;
+    offset += count;
+
+    return result;
   }
-  else
+
+  void skip(size_t count)
   {
-    setnilvalue(L->top);
-    L->top++;
+    if (require(count))
+      offset += count;
   }
-}
 
-struct ScopedSetGCThreshold
-{
-public:
-  ScopedSetGCThreshold(global_State *global, size_t newThreshold) noexcept
-      : global{global}
+  // moves to an offset recorded by an earlier pass over the same input
+  bool seek(size_t at)
   {
-    originalThreshold = global->GCthreshold;
-    global->GCthreshold = newThreshold;
+    if (at > size)
+      return fail_at(at, "offset out of range");
+
+    offset = at;
+    return !failed;
   }
 
-  ScopedSetGCThreshold(const ScopedSetGCThreshold &) = delete;
-  ScopedSetGCThreshold(ScopedSetGCThreshold &&) = delete;
+private:
+  uint32_t varint_slow()
+  {
+    const size_t start = offset;
 
-  ScopedSetGCThreshold &operator=(const ScopedSetGCThreshold &) = delete;
-  ScopedSetGCThreshold &operator=(ScopedSetGCThreshold &&) = delete;
+    uint32_t result = 0;
 
-  ~ScopedSetGCThreshold() noexcept
-  {
-    global->GCthreshold = originalThreshold;
+    // a 32-bit value takes at most five bytes
+    for (uint32_t shift = 0; shift < 35; shift += 7)
+    {
+      if (!require(1))
+        return 0;
+
+      const uint8_t byte = read_unchecked<uint8_t>();
+      result |= uint32_t(byte & 127) << shift;
+
+      if ((byte & 128) == 0)
+        return result;
+    }
+
+    fail_at(start, "varint longer than 5 bytes");
+    return 0;
   }
 
-private:
-  global_State *global = nullptr;
-  size_t originalThreshold = 0;
+  const char *data;
+  size_t size;
+  size_t offset = 0;
+
+  const char *section = "header";
+  bool failed = false;
+
+  sld::BytecodeError &error;
 };
 
-inline static void ltrim(std::string &s)
+// grows the way push_back would; reserve() on its own allocates exactly what is asked for, which would reallocate
+// once per function
+template <typename T>
+static void reserve_more(std::vector<T> &values, size_t count)
 {
-  s.erase(s.begin(), std::find_if(s.begin(), s.end(), [](unsigned char ch)
-                                  { return !std::isspace(ch); }));
+  const size_t needed = values.size() + count;
+
+  if (needed > values.capacity())
+    values.reserve(std::max(needed, values.capacity() * 2));
 }
 
-inline static void rtrim(std::string &s)
+// what sets the proto layout of one bytecode version apart from the others; every version read here has its own
+// specialization, so the proto readers below are compiled once per version without branching on it
+template <uint8_t version>
+struct ProtoLayout;
+
+// baseline: four header bytes, no type information
+template <>
+struct ProtoLayout<3>
 {
-  s.erase(std::find_if(s.rbegin(), s.rend(), [](unsigned char ch)
-                       { return !std::isspace(ch); })
-              .base(),
-          s.end());
-}
+  static constexpr size_t header_size = 4;
+  static constexpr bool has_types = false;
+};
 
-std::optional<std::string> sld::deserialize(const char *data, size_t size, BytecodeEncoding encoding)
+// adds the flags byte and the proto's type information
+template <>
+struct ProtoLayout<4>
 {
-  std::string disassembly{};
-  const char *chunkname = "simple_lua_disassembler";
-  int env = 0;
+  static constexpr size_t header_size = 5;
+  static constexpr bool has_types = true;
+};
 
-  lua_State *L = luaL_newstate();
+// adds vector constants and SUBRK/DIVRK, the layout is that of version 4
+template <>
+struct ProtoLayout<5> : ProtoLayout<4>
+{
+};
 
-  size_t offset = 0;
+// adds FASTCALL3, the layout is that of version 4
+template <>
+struct ProtoLayout<6> : ProtoLayout<4>
+{
+};
 
-  uint8_t version = read<uint8_t>(data, size, offset);
+// the proto readers of one version, picked once from the header byte
+struct ProtoDecoder
+{
+  bool (*read_all)(Reader &reader, uint32_t protoCount, Bytecode &bytecode);
+  bool (*read_one)(Reader &reader, uint32_t protoCount, Bytecode &bytecode, Function &p);
+  bool (*skip_all)(Reader &reader, sld::BytecodeIndex &index);
+};
+
+static const ProtoDecoder *find_decoder(uint8_t version);
+
+// version byte, types version and string table, which every way of reading a blob starts with; `decoder` is set to
+// the one for the blob's version
+static bool read_header(Reader &reader, std::string_view input, uint8_t &version, uint8_t &typesversion, std::vector<std::string_view> &strings, const ProtoDecoder *&decoder, sld::BytecodeError *error)
+{
+  version = reader.read<uint8_t>();
+
+  if (!reader.ok())
+  {
+    return false;
+  }
 
   // 0 means the rest of the bytecode is the error message
   if (version == 0)
   {
-    char chunkbuf[LUA_IDSIZE];
-    const char *chunkid = luaO_chunkid(chunkbuf, sizeof(chunkbuf), chunkname, strlen(chunkname));
-    lua_pushfstring(L, "%s%.*s", chunkid, int(size - offset), data + offset);
-    return {};
+    reader.fail_at(0, "bytecode holds a compilation error instead of code");
+
+    if (error != nullptr)
+      error->detail.assign(input.substr(1));
+
+    return false;
   }
 
-  if (version < LBC_VERSION_MIN || version > LBC_VERSION_MAX)
+  decoder = find_decoder(version);
+
+  if (decoder == nullptr)
   {
-    char chunkbuf[LUA_IDSIZE];
-    const char *chunkid = luaO_chunkid(chunkbuf, sizeof(chunkbuf), chunkname, strlen(chunkname));
-    lua_pushfstring(L, "%s: bytecode version mismatch (expected [%d..%d], got %d)", chunkid, LBC_VERSION_MIN, LBC_VERSION_MAX, version);
-    return {};
+    return reader.fail_at(0, "Invalid bytecode version detected");
   }
 
-  // we will allocate a fair amount of memory so check GC before we do
-  luaC_checkGC(L);
+  typesversion = 0;
+
+  if (version >= 4)
+  {
+    typesversion = reader.read<uint8_t>();
+  }
 
-  // pause GC for the duration of deserialization - some objects we're creating aren't rooted
-  const ScopedSetGCThreshold pauseGC{L->global, SIZE_MAX};
+  // string table
+  reader.enter("strings");
 
-  // env is 0 for current environment and a stack index otherwise
-  Table *envt = (env == 0) ? L->gt : hvalue(luaA_toobject(L, env));
+  const uint32_t stringCount = reader.varint();
 
-  TString *source = luaS_new(L, chunkname);
+  // every string takes at least its length byte, which bounds the reservation for bogus counts
+  if (!reader.require(stringCount))
+    return false;
 
-  uint8_t typesversion = 0;
+  strings.reserve(stringCount);
 
-  if (version >= 4)
+  for (uint32_t i = 0; i < stringCount; ++i)
   {
-    typesversion = read<uint8_t>(data, size, offset);
+    const uint32_t length = reader.varint();
+    const char *string = reader.bytes(length);
+
+    if (string == nullptr)
+      return false;
+
+    strings.emplace_back(string, length);
   }
 
-  // string table
-  unsigned int stringCount = readVarInt(data, size, offset);
-  TempBuffer<TString *> strings(L, stringCount);
+  // types version 3 maps userdata type indices to their names; they only matter to the type information
+  if (typesversion == 3)
+  {
+    reader.enter("userdata types");
+
+    for (uint8_t index = reader.read<uint8_t>(); index != 0 && reader.ok(); index = reader.read<uint8_t>())
+    {
+      const size_t name_offset = reader.position();
+
+      if (reader.varint() > strings.size())
+        return reader.fail_at(name_offset, "string index out of range");
+    }
+  }
+
+  return reader.ok();
+}
+
+// proto count, checked against the smallest size a proto can take
+static bool read_proto_count(Reader &reader, uint32_t &protoCount)
+{
+  reader.enter("protos");
+
+  protoCount = reader.varint();
+
+  // a proto is at least 9 bytes even when empty
+  return reader.require(size_t(protoCount) * 9);
+}
+
+// index of the main proto, which follows the last one
+static bool read_main(Reader &reader, uint32_t protoCount, uint32_t &mainid)
+{
+  reader.enter("main");
+
+  const size_t mainid_offset = reader.position();
+  mainid = reader.varint();
+
+  if (reader.ok() && mainid >= protoCount)
+    return reader.fail_at(mainid_offset, "main proto index out of range");
+
+  return reader.ok();
+}
 
-  for (unsigned int i = 0; i < stringCount; ++i)
+// line and debug info, neither of which is part of the listing
+static bool skip_debug_info(Reader &reader, uint32_t sizecode)
+{
+  reader.enter("lineinfo");
+
+  if (reader.read<uint8_t>())
   {
-    unsigned int length = readVarInt(data, size, offset);
+    const uint8_t linegaplog2 = reader.read<uint8_t>();
+
+    if (linegaplog2 >= 32)
+      return reader.fail("line gap out of range");
+
+    const size_t intervals = sizecode == 0 ? 0 : ((sizecode - 1) >> linegaplog2) + 1;
 
-    strings[i] = luaS_newlstr(L, data + offset, length);
-    offset += length;
+    // per-instruction line deltas followed by absolute line info for every interval
+    reader.skip(sizecode + intervals * sizeof(int32_t));
   }
 
-  // proto table
-  unsigned int protoCount = readVarInt(data, size, offset);
-  TempBuffer<Proto *> protos(L, protoCount);
+  reader.enter("debuginfo");
+
+  if (reader.read<uint8_t>())
+  {
+    const uint32_t sizelocvars = reader.varint();
+
+    for (uint32_t j = 0; j < sizelocvars && reader.ok(); ++j)
+    {
+      reader.varint();         // varname
+      reader.varint();         // startpc
+      reader.varint();         // endpc
+      reader.read<uint8_t>(); // reg
+    }
+
+    const uint32_t sizeupvalues = reader.varint();
+
+    for (uint32_t j = 0; j < sizeupvalues && reader.ok(); ++j)
+    {
+      reader.varint();
+    }
+  }
 
-  std::vector<std::vector<Constant>> proto_constants{};
+  return reader.ok();
+}
 
-  std::vector<std::pair<std::string, std::string>> disassembled_functions{};
-  disassembled_functions.reserve(protoCount);
+// reads the proto at the reader's position into `p`, appending its code and constants to `bytecode`
+template <uint8_t version>
+static bool read_proto(Reader &reader, uint32_t protoCount, Bytecode &bytecode, Function &p)
+{
+  using Layout = ProtoLayout<version>;
 
-  for (unsigned int i = 0; i < protoCount; ++i)
+  reader.enter("protos");
+
+  if (!reader.require(Layout::header_size))
+    return false;
+
+  p.maxstacksize = reader.read_unchecked<uint8_t>();
+  p.numparams = reader.read_unchecked<uint8_t>();
+  p.nups = reader.read_unchecked<uint8_t>();
+  p.is_vararg = reader.read_unchecked<uint8_t>();
+
+  if constexpr (Layout::has_types)
   {
-    Proto *p = luaF_newproto(L);
-    p->source = source;
-    p->bytecodeid = int(i);
+    p.flags = reader.read_unchecked<uint8_t>();
+
+    // type information is not part of the listing
+    reader.enter("types");
+    reader.skip(reader.varint());
+  }
+
+  reader.enter("code");
+
+  p.code_start = uint32_t(bytecode.code.size());
+  p.sizecode = reader.varint();
+
+  const char *words = reader.bytes(size_t(p.sizecode) * sizeof(uint32_t));
+
+  if (words == nullptr)
+    return false;
+
+  // the size was just checked against the input; the extra word keeps room for the sentinel after the last function
+  reserve_more(bytecode.code, size_t(p.sizecode) + 1);
+  bytecode.code.resize(p.code_start + p.sizecode);
+  uint32_t *code = bytecode.code.data() + p.code_start;
+
+  // encoded opcodes are decoded for all functions at once after the last one was read
+  if (p.sizecode != 0)
+    memcpy(code, words, size_t(p.sizecode) * sizeof(uint32_t));
+
+  reader.enter("constants");
 
-    p->maxstacksize = read<uint8_t>(data, size, offset); //
-    p->numparams = read<uint8_t>(data, size, offset);    //
-    p->nups = read<uint8_t>(data, size, offset);         //
-    p->is_vararg = read<uint8_t>(data, size, offset);    //
+  p.constants_start = uint32_t(bytecode.constants.size());
+  p.sizek = reader.varint();
 
-    uint32_t p_typesize = 0;
+  // every constant takes at least its type byte
+  if (!reader.require(p.sizek))
+    return false;
 
-    if (version >= 4)
+  reserve_more(bytecode.constants, p.sizek);
+
+  for (uint32_t j = 0; j < p.sizek; ++j)
+  {
+    Constant constant{};
+
+    const size_t start = reader.position();
+
+    switch (reader.read<uint8_t>())
     {
-      p->flags = read<uint8_t>(data, size, offset); //
+    case LBC_CONSTANT_NIL:
+      constant.type = Constant::Type_Nil;
+      break;
 
-      uint32_t typesize = readVarInt(data, size, offset); //
+    case LBC_CONSTANT_BOOLEAN:
+      constant.type = Constant::Type_Boolean;
+      constant.valueBoolean = reader.read<uint8_t>();
+      break;
 
-      if (typesize && typesversion == LBC_TYPE_VERSION)
-      {
-        uint8_t *types = (uint8_t *)data + offset;
+    case LBC_CONSTANT_NUMBER:
+      constant.type = Constant::Type_Number;
+      constant.valueNumber = reader.read<double>();
+      break;
 
-        LUAU_ASSERT(typesize == unsigned(2 + p->numparams));
-        LUAU_ASSERT(types[0] == LBC_TYPE_FUNCTION);
-        LUAU_ASSERT(types[1] == p->numparams);
+    case LBC_CONSTANT_VECTOR:
+      constant.type = Constant::Type_Vector;
 
-        p->typeinfo = luaM_newarray(L, typesize, uint8_t, p->memcat);
-        memcpy(p->typeinfo, types, typesize);
+      if (reader.require(4 * sizeof(float)))
+      {
+        constant.valueVector[0] = reader.read_unchecked<float>();
+        constant.valueVector[1] = reader.read_unchecked<float>();
+        constant.valueVector[2] = reader.read_unchecked<float>();
+        constant.valueVector[3] = reader.read_unchecked<float>();
       }
+      break;
 
-      offset += typesize;
-      p_typesize = typesize;
-    }
+    case LBC_CONSTANT_STRING:
+      constant.type = Constant::Type_String;
+      constant.valueString = reader.varint();
 
-    const int sizecode = readVarInt(data, size, offset); //
+      if (constant.valueString > bytecode.strings.size())
+        reader.fail_at(start, "string index out of range");
+      break;
 
-    p->code = luaM_newarray(L, sizecode, Instruction, p->memcat);
-    p->sizecode = sizecode;
+    case LBC_CONSTANT_IMPORT:
+      constant.type = Constant::Type_Import;
+      constant.valueImport = reader.read<uint32_t>();
+      break;
 
-    for (int j = 0; j < p->sizecode; ++j)
+    case LBC_CONSTANT_TABLE:
     {
-      auto instruction = read<uint32_t>(data, size, offset); //
+      // only the key count and keys are stored, the shape itself is never printed
+      const uint32_t keys = reader.varint();
 
-      if (encoding == BytecodeEncoding::Roblox)
+      for (uint32_t k = 0; k < keys && reader.ok(); ++k)
       {
-        uint8_t *ptr = reinterpret_cast<uint8_t *>(&instruction);
-        auto op = LUAU_INSN_OP(instruction);
-        op *= 203;
-        ptr[0] = static_cast<uint8_t>(op);
+        reader.varint();
       }
 
-      p->code[j] = instruction;
+      constant.type = Constant::Type_Table;
+      constant.valueTable = 0;
+      break;
     }
 
-    p->codeentry = p->code;
+    case LBC_CONSTANT_CLOSURE:
+      constant.type = Constant::Type_Closure;
+      constant.valueClosure = reader.varint();
 
-    const int sizek = readVarInt(data, size, offset); //
-    p->k = luaM_newarray(L, sizek, TValue, p->memcat);
-    p->sizek = sizek;
+      if (constant.valueClosure >= protoCount)
+        reader.fail_at(start, "closure index out of range");
+      break;
 
-    // Initialize the constants to nil to ensure they have a valid state
-    // in the event that some operation in the following loop fails with
-    // an exception.
-    for (int j = 0; j < p->sizek; ++j)
-    {
-      setnilvalue(&p->k[j]);
+    default:
+      reader.fail_at(start, "unknown constant type");
     }
 
-    std::vector<Constant> constants{};
+    if (!reader.ok())
+      return false;
 
-    for (int j = 0; j < p->sizek; ++j)
-    {
-      switch (read<uint8_t>(data, size, offset))
-      {
-      case LBC_CONSTANT_NIL:
-        // All constants have already been pre-initialized to nil
-        break;
+    bytecode.constants.push_back(constant);
+  }
 
-      case LBC_CONSTANT_BOOLEAN:
-      {
-        uint8_t v = read<uint8_t>(data, size, offset);
+  // imports name string constants of the same proto, which the VM expects to precede them; only their existence
+  // is required here
+  const Constant *constants = bytecode.constants.data() + p.constants_start;
 
-        Constant constant{};
-        constant.type = Constant::Type_Boolean;
-        constant.valueBoolean = v;
-        constants.push_back(constant);
+  for (uint32_t j = 0; j < p.sizek; ++j)
+  {
+    if (constants[j].type != Constant::Type_Import)
+      continue;
 
-        setbvalue(&p->k[j], v);
-        break;
-      }
+    for (uint32_t k = 0; k < (constants[j].valueImport >> 30); ++k)
+    {
+      const uint32_t id = (constants[j].valueImport >> (20 - k * 10)) & 1023;
 
-      case LBC_CONSTANT_NUMBER:
-      {
-        double v = read<double>(data, size, offset);
+      if (id >= p.sizek || constants[id].type != Constant::Type_String)
+        return reader.fail("import refers to an invalid constant");
+    }
+  }
 
-        Constant constant{};
-        constant.type = Constant::Type_Number;
-        constant.valueNumber = v;
-        constants.push_back(constant);
+  // child protos are only referenced by index from NEWCLOSURE
+  reader.enter("children");
 
-        setnvalue(&p->k[j], v);
-        break;
-      }
+  const uint32_t sizep = reader.varint();
 
-      case LBC_CONSTANT_VECTOR:
-      {
-        float x = read<float>(data, size, offset);
-        float y = read<float>(data, size, offset);
-        float z = read<float>(data, size, offset);
-        float w = read<float>(data, size, offset);
-
-        Constant constant{};
-        constant.type = Constant::Type_Vector;
-        constant.valueVector[0] = x;
-        constant.valueVector[1] = y;
-        constant.valueVector[2] = z;
-        constant.valueVector[3] = w;
-        constants.push_back(constant);
-
-        (void)w;
-        setvvalue(&p->k[j], x, y, z, w);
-        break;
-      }
+  for (uint32_t j = 0; j < sizep && reader.ok(); ++j)
+  {
+    reader.varint();
+  }
 
-      case LBC_CONSTANT_STRING:
-      {
-        unsigned int id = readVarInt(data, size, offset);
+  reader.enter("debug");
 
-        Constant constant{};
-        constant.type = Constant::Type_String;
-        constant.valueString = id;
-        constants.push_back(constant);
+  p.linedefined = reader.varint();
 
-        TString *v = id == 0 ? NULL : strings[id - 1];
+  const size_t debugname_offset = reader.position();
+  const uint32_t debugname = reader.varint();
 
-        // TString* v = readString(strings, data, size, offset);
-        setsvalue(L, &p->k[j], v);
-        break;
-      }
+  if (debugname > bytecode.strings.size())
+    return reader.fail_at(debugname_offset, "string index out of range");
 
-      case LBC_CONSTANT_IMPORT:
-      {
-        uint32_t iid = read<uint32_t>(data, size, offset);
+  p.debugname = bytecode.string(debugname);
 
-        Constant constant{};
-        constant.type = Constant::Type_Import;
-        constant.valueString = iid;
-        constants.push_back(constant);
+  return skip_debug_info(reader, p.sizecode);
+}
 
-        resolveImportSafe(L, envt, p->k, iid);
-        setobj(L, &p->k[j], L->top - 1);
-        L->top--;
-        break;
-      }
+// steps over the proto at the reader's position, keeping only what `info` describes; nothing is copied or decoded
+template <uint8_t version>
+static bool skip_proto(Reader &reader, const sld::BytecodeIndex &index, sld::ProtoInfo &info)
+{
+  using Layout = ProtoLayout<version>;
 
-      case LBC_CONSTANT_TABLE:
-      {
-        int keys = readVarInt(data, size, offset);
-
-        Constant constant{};
-        constant.type = Constant::Type_Table;
-        constant.valueTable = 0;
-        constants.push_back(constant);
-
-        Table *h = luaH_new(L, 0, keys);
-        for (int i = 0; i < keys; ++i)
-        {
-          int key = readVarInt(data, size, offset);
-          TValue *val = luaH_set(L, h, &p->k[key]);
-          setnvalue(val, 0.0);
-        }
-        sethvalue(L, &p->k[j], h);
-        break;
-      }
+  reader.enter("protos");
 
-      case LBC_CONSTANT_CLOSURE:
-      {
-        uint32_t fid = readVarInt(data, size, offset);
+  info.offset = reader.position();
 
-        Constant constant{};
-        constant.type = Constant::Type_Closure;
-        constant.valueClosure = fid;
-        constants.push_back(constant);
+  reader.skip(Layout::header_size);
 
-        Closure *cl = luaF_newLclosure(L, protos[fid]->nups, envt, protos[fid]);
-        cl->preload = (cl->nupvalues > 0);
-        setclvalue(L, &p->k[j], cl);
-        break;
-      }
+  if constexpr (Layout::has_types)
+  {
+    reader.enter("types");
+    reader.skip(reader.varint());
+  }
 
-      default:
-        LUAU_ASSERT(!"Unexpected constant kind");
-      }
-    }
+  reader.enter("code");
+
+  info.sizecode = reader.varint();
+  reader.skip(size_t(info.sizecode) * sizeof(uint32_t));
 
-    proto_constants.push_back(constants);
+  reader.enter("constants");
 
-    const int sizep = readVarInt(data, size, offset); //
-    p->p = luaM_newarray(L, sizep, Proto *, p->memcat);
-    p->sizep = sizep;
+  info.sizek = reader.varint();
+
+  for (uint32_t j = 0; j < info.sizek && reader.ok(); ++j)
+  {
+    const size_t start = reader.position();
 
-    for (int j = 0; j < p->sizep; ++j)
+    switch (reader.read<uint8_t>())
     {
-      uint32_t fid = readVarInt(data, size, offset); //
-      p->p[j] = protos[fid];
-    }
+    case LBC_CONSTANT_NIL:
+      break;
 
-    p->linedefined = readVarInt(data, size, offset);        //
-    p->debugname = readString(strings, data, size, offset); //
+    case LBC_CONSTANT_BOOLEAN:
+      reader.skip(1);
+      break;
 
-    uint8_t lineinfo = read<uint8_t>(data, size, offset); //
+    case LBC_CONSTANT_NUMBER:
+      reader.skip(sizeof(double));
+      break;
 
-    if (lineinfo)
-    {
-      p->linegaplog2 = read<uint8_t>(data, size, offset); //
+    case LBC_CONSTANT_VECTOR:
+      reader.skip(4 * sizeof(float));
+      break;
 
-      int intervals = ((p->sizecode - 1) >> p->linegaplog2) + 1;
-      int absoffset = (p->sizecode + 3) & ~3;
+    case LBC_CONSTANT_STRING:
+    case LBC_CONSTANT_CLOSURE:
+      reader.varint();
+      break;
 
-      const int sizelineinfo = absoffset + intervals * sizeof(int);
-      p->lineinfo = luaM_newarray(L, sizelineinfo, uint8_t, p->memcat);
-      p->sizelineinfo = sizelineinfo;
+    case LBC_CONSTANT_IMPORT:
+      reader.skip(sizeof(uint32_t));
+      break;
 
-      p->abslineinfo = (int *)(p->lineinfo + absoffset);
+    case LBC_CONSTANT_TABLE:
+    {
+      const uint32_t keys = reader.varint();
 
-      uint8_t lastoffset = 0;
-      for (int j = 0; j < p->sizecode; ++j)
+      for (uint32_t k = 0; k < keys && reader.ok(); ++k)
       {
-        lastoffset += read<uint8_t>(data, size, offset); //
-        p->lineinfo[j] = lastoffset;
+        reader.varint();
       }
+      break;
+    }
 
-      int lastline = 0;
-      for (int j = 0; j < intervals; ++j)
-      {
-        lastline += read<int32_t>(data, size, offset); //
-        p->abslineinfo[j] = lastline;
-      }
+    default:
+      reader.fail_at(start, "unknown constant type");
     }
+  }
 
-    uint8_t debuginfo = read<uint8_t>(data, size, offset); //
+  reader.enter("children");
 
-    if (debuginfo)
-    {
-      const int sizelocvars = readVarInt(data, size, offset); //
-      p->locvars = luaM_newarray(L, sizelocvars, LocVar, p->memcat);
-      p->sizelocvars = sizelocvars;
+  const uint32_t sizep = reader.varint();
 
-      for (int j = 0; j < p->sizelocvars; ++j)
-      {
-        p->locvars[j].varname = readString(strings, data, size, offset);
-        p->locvars[j].startpc = readVarInt(data, size, offset);
-        p->locvars[j].endpc = readVarInt(data, size, offset);
-        p->locvars[j].reg = read<uint8_t>(data, size, offset);
-      }
+  for (uint32_t j = 0; j < sizep && reader.ok(); ++j)
+  {
+    reader.varint();
+  }
 
-      const int sizeupvalues = readVarInt(data, size, offset);
-      p->upvalues = luaM_newarray(L, sizeupvalues, TString *, p->memcat);
-      p->sizeupvalues = sizeupvalues;
+  reader.enter("debug");
 
-      for (int j = 0; j < p->sizeupvalues; ++j)
-      {
-        p->upvalues[j] = readString(strings, data, size, offset);
-      }
-    }
+  info.linedefined = reader.varint();
+
+  const size_t debugname_offset = reader.position();
+  const uint32_t debugname = reader.varint();
+
+  if (debugname > index.strings.size())
+    return reader.fail_at(debugname_offset, "string index out of range");
 
-    protos[i] = p;
+  info.debugname = index.string(debugname);
+
+  return skip_debug_info(reader, info.sizecode);
+}
+
+template <uint8_t version>
+static bool read_protos(Reader &reader, uint32_t protoCount, Bytecode &bytecode)
+{
+  for (uint32_t i = 0; i < protoCount; ++i)
+  {
+    Function p{};
+
+    if (!read_proto<version>(reader, protoCount, bytecode, p))
+      return false;
+
+    bytecode.functions.push_back(p);
   }
 
-  for (std::size_t i = 0; i < protos.count; i++)
+  return true;
+}
+
+template <uint8_t version>
+static bool skip_protos(Reader &reader, sld::BytecodeIndex &index)
+{
+  for (auto &info : index.protos)
   {
-    const auto proto = protos.data[i];
+    if (!skip_proto<version>(reader, index, info))
+      return false;
+  }
 
-    const auto debug_name = ([&]()
-                             {
-                if (proto->debugname == nullptr || proto->debugname->len == 0) {
-                    return std::string("__unnamed_function__");
-                }
+  return true;
+}
 
-                return std::string(proto->debugname->data, proto->debugname->len); })();
+template <uint8_t version>
+static constexpr ProtoDecoder make_decoder()
+{
+  return {read_protos<version>, read_proto<version>, skip_protos<version>};
+}
 
-    std::vector<Instruction> instructions{};
-    instructions.reserve(proto->sizecode);
+// supporting a new version takes a ProtoLayout specialization and an entry here
+static constexpr uint8_t first_version = 3;
 
-    disassembly.append("[");
-    disassembly.append(debug_name);
-    disassembly.append("]\n");
+static constexpr ProtoDecoder decoders[] = {
+    make_decoder<3>(),
+    make_decoder<4>(),
+    make_decoder<5>(),
+    make_decoder<6>(),
+};
 
-    const auto &constants = proto_constants.at(i);
+static const ProtoDecoder *find_decoder(uint8_t version)
+{
+  if (version < first_version || size_t(version - first_version) >= std::size(decoders))
+    return nullptr;
 
-    for (int j = 0; j < proto->sizecode;)
-    {
-      const uint32_t *code = &proto->code[j];
-      uint8_t op = LUAU_INSN_OP(*code);
+  return &decoders[version - first_version];
+}
 
-      if (op == LOP_PREPVARARGS)
-      {
-        // Don't emit function header in bytecode - it's used for call dispatching and doesn't contain "interesting" information
-        j++;
-        continue;
-      }
+bool sld::read_bytecode(std::string_view input, BytecodeEncoding encoding, Bytecode &bytecode, BytecodeError *error)
+{
+  bytecode.clear();
 
-      dumpInstruction(strings, constants, protos, code, disassembly, 0);
-      j += Luau::getOpLength(LuauOpcode(op));
-    }
+  BytecodeError ignored;
+  Reader reader(input, error != nullptr ? *error : ignored);
+
+  if (encoding != BytecodeEncoding::Auto && encoding_name(encoding).empty())
+  {
+    return reader.fail_at(0, "unknown opcode encoding");
+  }
+
+  const ProtoDecoder *decoder = nullptr;
+
+  if (!read_header(reader, input, bytecode.version, bytecode.typesversion, bytecode.strings, decoder, error))
+  {
+    return false;
+  }
+
+  // proto table
+  uint32_t protoCount = 0;
+
+  if (!read_proto_count(reader, protoCount))
+    return false;
+
+  bytecode.functions.reserve(protoCount);
+
+  if (!decoder->read_all(reader, protoCount, bytecode))
+    return false;
+
+  if (!read_main(reader, protoCount, bytecode.mainid))
+    return false;
+
+  bytecode.encoding = encoding == BytecodeEncoding::Auto ? detect_encoding(bytecode) : encoding;
+
+  decode_opcodes(bytecode.code.data(), bytecode.code.size(), bytecode.encoding);
+
+  // an aux word is read alongside every instruction that has one; this keeps a truncated last instruction from
+  // reading past the code without checking every instruction
+  bytecode.code.push_back(0);
+
+  return reader.ok();
+}
+
+bool sld::inspect_bytecode(std::string_view input, BytecodeIndex &index, BytecodeError *error)
+{
+  index.clear();
+
+  BytecodeError ignored;
+  Reader reader(input, error != nullptr ? *error : ignored);
+
+  const ProtoDecoder *decoder = nullptr;
+
+  if (!read_header(reader, input, index.version, index.typesversion, index.strings, decoder, error))
+  {
+    return false;
+  }
+
+  uint32_t protoCount = 0;
+
+  if (!read_proto_count(reader, protoCount))
+    return false;
+
+  index.protos.resize(protoCount);
+
+  if (!decoder->skip_all(reader, index))
+    return false;
+
+  return read_main(reader, protoCount, index.mainid);
+}
+
+bool sld::read_function(std::string_view input, const BytecodeIndex &index, uint32_t id, BytecodeEncoding encoding, Bytecode &bytecode, BytecodeError *error)
+{
+  bytecode.clear();
+
+  BytecodeError ignored;
+  Reader reader(input, error != nullptr ? *error : ignored);
+
+  if (encoding != BytecodeEncoding::Auto && encoding_name(encoding).empty())
+  {
+    return reader.fail_at(0, "unknown opcode encoding");
+  }
+
+  reader.enter("protos");
+
+  if (id >= index.protos.size())
+  {
+    return reader.fail_at(0, "function index out of range");
+  }
 
-    disassembly.append("\n");
+  bytecode.version = index.version;
+  bytecode.typesversion = index.typesversion;
+  bytecode.mainid = index.mainid;
+  bytecode.strings.assign(index.strings.begin(), index.strings.end());
+
+  // the other functions only carry what closure constants print of them
+  bytecode.functions.resize(index.protos.size());
+
+  for (size_t i = 0; i < index.protos.size(); ++i)
+  {
+    bytecode.functions[i].linedefined = index.protos[i].linedefined;
+    bytecode.functions[i].debugname = index.protos[i].debugname;
   }
 
-  // "main" proto is pushed to Lua stack
-  uint32_t mainid = readVarInt(data, size, offset);
-  Proto *main = protos[mainid];
+  if (!reader.seek(index.protos[id].offset))
+    return false;
+
+  const ProtoDecoder *decoder = find_decoder(index.version);
+
+  if (decoder == nullptr)
+    return reader.fail_at(0, "Invalid bytecode version detected");
 
-  luaC_threadbarrier(L);
+  Function p{};
 
-  Closure *cl = luaF_newLclosure(L, 0, envt, main);
-  setclvalue(L, L->top, cl);
-  incr_top(L);
+  if (!decoder->read_one(reader, uint32_t(index.protos.size()), bytecode, p))
+    return false;
 
-  ltrim(disassembly);
-  rtrim(disassembly);
+  bytecode.functions[id] = p;
+
+  // with a single function to go by, detection only samples that one
+  bytecode.encoding = encoding == BytecodeEncoding::Auto ? detect_encoding(bytecode) : encoding;
+
+  decode_opcodes(bytecode.code.data(), bytecode.code.size(), bytecode.encoding);
+  bytecode.code.push_back(0);
+
+  return reader.ok();
+}
+
+std::optional<std::string> sld::deserialize(std::string_view data, BytecodeEncoding encoding, BytecodeError *error)
+{
+  Bytecode bytecode{};
+
+  if (!read_bytecode(data, encoding, bytecode, error))
+  {
+    return {};
+  }
+
+  std::string disassembly{};
+  dumpBytecode(bytecode, disassembly);
 
   return disassembly;
 }
@@ -2,10 +2,23 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 
+#include "../bytecode/bytecode.hpp"
 #include "../disassembler/disassembler.hpp"
 
 namespace sld
 {
-  std::optional<std::string> deserialize(const char *data, size_t len, BytecodeEncoding encoding = BytecodeEncoding::Luau);
-}
\ No newline at end of file
+  // parses in place, string views in `bytecode` point into `data`; on failure `error` (if any) says where and why
+  bool read_bytecode(std::string_view data, BytecodeEncoding encoding, Bytecode &bytecode, BytecodeError *error = nullptr);
+
+  // records the header, string table and the offset, name and size of every proto without copying or decoding any
+  // of them; far cheaper than read_bytecode when only a few functions are wanted
+  bool inspect_bytecode(std::string_view data, BytecodeIndex &index, BytecodeError *error = nullptr);
+
+  // reads only proto `id` of `data`, seeking to the offset `index` (from inspect_bytecode over the same data) has for
+  // it. The other entries of `bytecode.functions` are empty apart from their name and line
+  bool read_function(std::string_view data, const BytecodeIndex &index, uint32_t id, BytecodeEncoding encoding, Bytecode &bytecode, BytecodeError *error = nullptr);
+
+  std::optional<std::string> deserialize(std::string_view data, BytecodeEncoding encoding = BytecodeEncoding::Luau, BytecodeError *error = nullptr);
+}
@@ -1,16 +1,281 @@
 #include "disassembler.hpp"
+#include "../cache/cache.hpp"
 #include "../deserializer/deserializer.hpp"
+#include "../dumper/dumper.hpp"
 
 #include <Luau/Compiler.h>
 
-std::optional<std::string> sld::disassemble(const std::string &script)
+#include <utility>
+
+std::optional<std::string> sld::disassemble(const std::string &script, const DisassembleOptions &options, const CompileOptions &compile_options)
+{
+  const auto disassembly = Disassembler::for_thread().disassemble(script, options, compile_options);
+
+  if (!disassembly.has_value())
+  {
+    return {};
+  }
+
+  return std::string(disassembly.value());
+}
+
+std::optional<std::string> sld::disassemble_bytecode(std::string_view bytecode, const DisassembleOptions &options)
+{
+  const auto disassembly = Disassembler::for_thread().disassemble_bytecode(bytecode, options);
+
+  if (!disassembly.has_value())
+  {
+    return {};
+  }
+
+  return std::string(disassembly.value());
+}
+
+// the free functions share one context per thread, so repeated calls don't rebuild their tables from scratch
+sld::Disassembler &sld::Disassembler::for_thread()
+{
+  thread_local Disassembler disassembler{};
+  return disassembler;
+}
+
+sld::Disassembler::Disassembler(size_t retained_bytes)
+    : retained_limit(retained_bytes)
+{
+}
+
+static const char *optional_name(const std::string &name)
+{
+  return name.empty() ? nullptr : name.c_str();
+}
+
+std::optional<std::string_view> sld::Disassembler::disassemble(const std::string &script, const DisassembleOptions &options, const CompileOptions &compile_options)
 {
-  const auto bytecode = Luau::compile(script);
+  recycle();
+
+  Luau::CompileOptions luau_options;
+  luau_options.optimizationLevel = compile_options.optimization_level;
+  luau_options.debugLevel = compile_options.debug_level;
+  luau_options.vectorLib = optional_name(compile_options.vector_lib);
+  luau_options.vectorCtor = optional_name(compile_options.vector_ctor);
+  luau_options.vectorType = optional_name(compile_options.vector_type);
+
+  // compiled bytecode is never encoded
+  DisassembleOptions compiled_options = options;
+  compiled_options.encoding = BytecodeEncoding::Luau;
+
+  auto &cache = ResultCache::compiled();
+
+  if (!cache.enabled())
+  {
+    // a script that doesn't compile comes back as the error message, which the reader reports
+    compiled = Luau::compile(script, luau_options);
+
+    return run_cached(compiled, compiled_options);
+  }
+
+  const CacheKey key = ResultCache::key(script, compile_options);
+
+  // read straight from the cached copy, which this reference keeps alive while the listing is made
+  if (const auto bytecode = cache.find(key, script))
+  {
+    return run_cached(*bytecode, compiled_options);
+  }
+
+  // compilation errors are as deterministic as bytecode, so they are kept too
+  compiled = Luau::compile(script, luau_options);
+  cache.insert(key, script, compiled);
+
+  return run_cached(compiled, compiled_options);
+}
+
+std::optional<std::string_view> sld::Disassembler::disassemble_bytecode(std::string_view bytecode, const DisassembleOptions &options)
+{
+  recycle();
+
+  return run_cached(bytecode, options);
+}
+
+std::optional<std::string_view> sld::Disassembler::run_cached(std::string_view bytecode, const DisassembleOptions &options)
+{
+  auto &cache = ResultCache::shared();
+
+  if (!cache.enabled())
+  {
+    return run(bytecode, options);
+  }
+
+  const CacheKey key = ResultCache::key(bytecode, options.encoding);
+
+  if (const auto listing = cache.find(key, bytecode))
+  {
+    output.assign(*listing);
+    return std::string_view(output);
+  }
+
+  const auto disassembly = run(bytecode, options);
+
+  if (disassembly.has_value())
+  {
+    cache.insert(key, bytecode, disassembly.value());
+  }
+
+  return disassembly;
+}
+
+bool sld::Disassembler::disassemble_bytecode_to(Sink &sink, std::string_view data, const DisassembleOptions &options)
+{
+  recycle();
+
+  // streamed listings are too big to be worth keeping, but one that was kept is the cheapest to stream
+  auto &cache = ResultCache::shared();
+
+  if (cache.enabled())
+  {
+    if (const auto listing = cache.find(ResultCache::key(data, options.encoding), data))
+    {
+      sink.write(*listing);
+      return true;
+    }
+  }
 
-  return deserialize(bytecode.data(), bytecode.size());
+  if (!read_bytecode(data, options.encoding, bytecode, &error))
+  {
+    return false;
+  }
+
+  Writer writer(sink);
+  dumpBytecode(bytecode, writer, scratch, options.parallel, options.pool);
+
+  return true;
+}
+
+const sld::Bytecode *sld::Disassembler::read(std::string_view data, const DisassembleOptions &options)
+{
+  recycle();
+
+  if (!read_bytecode(data, options.encoding, bytecode, &error))
+  {
+    return nullptr;
+  }
+
+  return &bytecode;
+}
+
+const sld::BytecodeIndex *sld::Disassembler::inspect(std::string_view data)
+{
+  recycle();
+
+  if (!inspect_bytecode(data, index, &error))
+  {
+    return nullptr;
+  }
+
+  return &index;
+}
+
+std::optional<std::string_view> sld::Disassembler::disassemble_function(std::string_view data, uint32_t id, const DisassembleOptions &options)
+{
+  recycle();
+
+  if (!inspect_bytecode(data, index, &error))
+  {
+    return {};
+  }
+
+  return run_function(data, id, options);
+}
+
+std::optional<std::string_view> sld::Disassembler::disassemble_function(std::string_view data, std::string_view name, const DisassembleOptions &options)
+{
+  recycle();
+
+  if (!inspect_bytecode(data, index, &error))
+  {
+    return {};
+  }
+
+  const auto id = index.find(name);
+
+  if (!id.has_value())
+  {
+    error = {};
+    error.section = "protos";
+    error.reason = "no function with that name";
+
+    return {};
+  }
+
+  return run_function(data, id.value(), options);
+}
+
+std::optional<std::string_view> sld::Disassembler::run_function(std::string_view data, uint32_t id, const DisassembleOptions &options)
+{
+  output.clear();
+
+  if (!read_function(data, index, id, options.encoding, bytecode, &error))
+  {
+    return {};
+  }
+
+  {
+    // trims the output to what was written when it goes out of scope
+    Writer writer(output);
+    dumpFunction(bytecode, bytecode.functions[id], writer, scratch.function);
+  }
+
+  return std::string_view(output);
+}
+
+std::optional<std::string_view> sld::Disassembler::run(std::string_view data, const DisassembleOptions &options)
+{
+  output.clear();
+
+  if (!read_bytecode(data, options.encoding, bytecode, &error))
+  {
+    return {};
+  }
+
+  {
+    // trims the output to what was written when it goes out of scope
+    Writer writer(output);
+    dumpBytecode(bytecode, writer, scratch, options.parallel, options.pool);
+  }
+
+  return std::string_view(output);
+}
+
+void sld::Disassembler::reset()
+{
+  bytecode.release();
+  index.release();
+
+  // swap rather than assign, move-assigning a short string keeps the old heap buffer around
+  std::string{}.swap(compiled);
+  std::string{}.swap(output);
+
+  DumpScratch released;
+  std::swap(scratch, released);
+
+  ControlFlowScratch released_flow;
+  std::swap(flow_scratch, released_flow);
+}
+
+size_t sld::Disassembler::retained_bytes() const
+{
+  return bytecode.strings.capacity() * sizeof(std::string_view) +
+         bytecode.functions.capacity() * sizeof(Function) +
+         bytecode.constants.capacity() * sizeof(Constant) +
+         bytecode.code.capacity() * sizeof(uint32_t) +
+         index.strings.capacity() * sizeof(std::string_view) +
+         index.protos.capacity() * sizeof(ProtoInfo) +
+         compiled.capacity() + output.capacity() + scratch.retained_bytes() + flow_scratch.retained_bytes();
 }
 
-std::optional<std::string> sld::disassemble_bytecode(const std::string &bytecode, sld::BytecodeEncoding encoding)
+void sld::Disassembler::recycle()
 {
-  return deserialize(bytecode.data(), bytecode.size(), encoding);
+  // an unusually large input would otherwise pin its peak footprint for the lifetime of the context
+  if (retained_bytes() > retained_limit)
+  {
+    reset();
+  }
 }
@@ -2,18 +2,119 @@
 
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <cstdint>
 
+#include "../analysis/cfg.hpp"
+#include "../bytecode/bytecode.hpp"
+#include "../dumper/dumper.hpp"
+#include "../dumper/sink.hpp"
+
 namespace sld
 {
-  enum BytecodeEncoding
+  class ThreadPool;
+
+  struct DisassembleOptions
+  {
+    DisassembleOptions(BytecodeEncoding encoding = BytecodeEncoding::Luau)
+        : encoding(encoding)
+    {
+    }
+
+    BytecodeEncoding encoding;
+
+    // format functions on a thread pool, only worth it for bundles with many functions
+    bool parallel = false;
+
+    // the pool they are split across, the shared one when unset
+    ThreadPool *pool = nullptr;
+  };
+
+  // what scripts are compiled with, the defaults are Luau's own
+  struct CompileOptions
   {
-    Luau,
-    Roblox
+    int optimization_level = 1;
+    int debug_level = 1;
+
+    // library, constructor and type name of vectors, which lets the compiler fold vector constructor calls; empty
+    // ones are left unset
+    std::string vector_lib;
+    std::string vector_ctor;
+    std::string vector_type;
   };
 
   std::optional<std::string>
-  disassemble(const std::string &script);
-  std::optional<std::string> disassemble_bytecode(const std::string &script, BytecodeEncoding encoding = BytecodeEncoding::Luau);
-}
\ No newline at end of file
+  disassemble(const std::string &script, const DisassembleOptions &options = {}, const CompileOptions &compile_options = {});
+  std::optional<std::string> disassemble_bytecode(std::string_view bytecode, const DisassembleOptions &options = {});
+
+  // reusable disassembly context; keeps its parse tables and output buffer between calls so that a long-lived
+  // caller pays for allocations once, and drops anything above `retained_bytes` before the next call
+  class Disassembler
+  {
+  public:
+    static constexpr size_t default_retained_bytes = 4 * 1024 * 1024;
+
+    explicit Disassembler(size_t retained_bytes = default_retained_bytes);
+
+    Disassembler(const Disassembler &) = delete;
+    Disassembler &operator=(const Disassembler &) = delete;
+
+    // context shared by everything running on the calling thread
+    static Disassembler &for_thread();
+
+    // the returned view points into this context and stays valid until the next call
+    std::optional<std::string_view> disassemble(const std::string &script, const DisassembleOptions &options = {}, const CompileOptions &compile_options = {});
+    // `bytecode` is parsed in place and only has to outlive the call
+    std::optional<std::string_view> disassemble_bytecode(std::string_view bytecode, const DisassembleOptions &options = {});
+
+    // streams the listing into `sink` in chunks instead of collecting it; false if the bytecode could not be read,
+    // in which case nothing was written
+    bool disassemble_bytecode_to(Sink &sink, std::string_view bytecode, const DisassembleOptions &options = {});
+
+    // only parses the bytecode; the result points into this context and `bytecode`, and stays valid until the next call
+    const Bytecode *read(std::string_view bytecode, const DisassembleOptions &options = {});
+
+    // only skims the bytecode for where its protos are, see inspect_bytecode; the result points into this context and
+    // `bytecode`, and stays valid until the next call
+    const BytecodeIndex *inspect(std::string_view bytecode);
+
+    // the listing of a single proto, by index or by name (the first one with it); only that proto is read
+    std::optional<std::string_view> disassemble_function(std::string_view bytecode, uint32_t id, const DisassembleOptions &options = {});
+    std::optional<std::string_view> disassemble_function(std::string_view bytecode, std::string_view name, const DisassembleOptions &options = {});
+
+    // why the last call failed
+    const BytecodeError &last_error() const
+    {
+      return error;
+    }
+
+    // scratch for building the control flow graphs of what read() returned; counted and released with the rest
+    ControlFlowScratch &control_flow_scratch()
+    {
+      return flow_scratch;
+    }
+
+    // releases all retained memory
+    void reset();
+
+    size_t retained_bytes() const;
+
+  private:
+    void recycle();
+    std::optional<std::string_view> run(std::string_view data, const DisassembleOptions &options);
+    // run() through the listing cache when it's enabled
+    std::optional<std::string_view> run_cached(std::string_view data, const DisassembleOptions &options);
+    std::optional<std::string_view> run_function(std::string_view data, uint32_t id, const DisassembleOptions &options);
+
+    size_t retained_limit;
+
+    Bytecode bytecode;
+    BytecodeIndex index;
+    BytecodeError error;
+    std::string compiled;
+    std::string output;
+    DumpScratch scratch;
+    ControlFlowScratch flow_scratch;
+  };
+}
@@ -1,52 +1,20 @@
 #include "dumper.hpp"
+#include "../analysis/analysis.hpp"
+#include "../bytecode/opcodes.hpp"
+#include "../pool/pool.hpp"
 
 #include <Luau/Bytecode.h>
+#include <Luau/BytecodeUtils.h>
 
-using sld::Constant, sld::TempBuffer;
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
 
-void vformatAppend(std::string &ret, const char *fmt, va_list args)
-{
-  va_list argscopy;
-  va_copy(argscopy, args);
-#ifdef _MSC_VER
-  int actualSize = _vscprintf(fmt, argscopy);
-#else
-  int actualSize = vsnprintf(NULL, 0, fmt, argscopy);
-#endif
-  va_end(argscopy);
-
-  if (actualSize <= 0)
-    return;
-
-  size_t sz = ret.size();
-  ret.resize(sz + actualSize);
-  vsnprintf(&ret[0] + sz, actualSize + 1, fmt, args);
-}
-
-std::string format(const char *fmt, ...)
-{
-  std::string result;
-  va_list args;
-  va_start(args, fmt);
-  vformatAppend(result, fmt, args);
-  va_end(args);
-  return result;
-}
-
-void formatAppend(std::string &str, const char *fmt, ...)
-{
-  va_list args;
-  va_start(args, fmt);
-  vformatAppend(str, fmt, args);
-  va_end(args);
-}
-
-std::string vformat(const char *fmt, va_list args)
-{
-  std::string ret;
-  vformatAppend(ret, fmt, args);
-  return ret;
-}
+using sld::Bytecode, sld::Constant, sld::Function, sld::PcSet, sld::Writer;
 
 #include <string_view>
 
@@ -84,38 +52,43 @@ int decomposeImportId(uint32_t ids, int32_t &id0, int32_t &id1, int32_t &id2)
   return count;
 }
 
-void dumpConstant(TempBuffer<TString *> &string_table, const std::vector<Constant> &constants, TempBuffer<Proto *> &protos, std::string &result, int k)
+void dumpConstant(const Bytecode &bytecode, const Function &function, Writer &result, int k)
 {
+  // operands aren't validated by the reader, an out of range index prints nothing
+  if (k < 0 || uint32_t(k) >= function.sizek)
+    return;
+
+  const Constant *constants = bytecode.constants_of(function);
   const Constant &data = constants[k];
 
   switch (data.type)
   {
   case Constant::Type_Nil:
-    formatAppend(result, "nil");
+    result.append("nil");
     break;
   case Constant::Type_Boolean:
-    formatAppend(result, "%s", data.valueBoolean ? "true" : "false");
+    result.append(data.valueBoolean ? "true" : "false");
     break;
   case Constant::Type_Number:
-    formatAppend(result, "%.17g", data.valueNumber);
+    result.number(data.valueNumber, 17);
     break;
   case Constant::Type_Vector:
+    result.number(data.valueVector[0], 9).append(", ").number(data.valueVector[1], 9).append(", ").number(data.valueVector[2], 9);
+
     // 3-vectors is the most common configuration, so truncate to three components if possible
-    if (data.valueVector[3] == 0.0)
-      formatAppend(result, "%.9g, %.9g, %.9g", data.valueVector[0], data.valueVector[1], data.valueVector[2]);
-    else
-      formatAppend(result, "%.9g, %.9g, %.9g, %.9g", data.valueVector[0], data.valueVector[1], data.valueVector[2], data.valueVector[3]);
+    if (data.valueVector[3] != 0.0)
+      result.append(", ").number(data.valueVector[3], 9);
     break;
   case Constant::Type_String:
   {
-    const TString *str = string_table.data[data.valueString - 1];
+    const std::string_view str = bytecode.string(data.valueString);
 
-    if (printableStringConstant(str->data, str->len))
+    if (printableStringConstant(str.data(), str.size()))
     {
-      if (str->len < 32)
-        formatAppend(result, "'%.*s'", int(str->len), str->data);
+      if (str.size() < 32)
+        result.append('\'').append(str).append('\'');
       else
-        formatAppend(result, "'%.*s'...", 32, str->data);
+        result.append('\'').append(str.substr(0, 32)).append("'...");
     }
     break;
   }
@@ -124,459 +97,400 @@ void dumpConstant(TempBuffer<TString *> &string_table, const std::vector<Constan
     int id0 = -1, id1 = -1, id2 = -1;
     if (int count = decomposeImportId(data.valueImport, id0, id1, id2))
     {
-      {
-        const Constant &id = constants[id0];
-        // LUAU_ASSERT(id.type == Constant::Type_String && id.valueString <= debugStrings.size());
-
-        const TString *str = string_table.data[id.valueString - 1];
-        formatAppend(result, "%.*s", int(str->len), str->data);
-      }
+      result.append(bytecode.string(constants[id0].valueString));
 
       if (count > 1)
-      {
-        const Constant &id = constants[id1];
-        // LUAU_ASSERT(id.type == Constant::Type_String && id.valueString <= debugStrings.size());
-
-        const TString *str = string_table.data[id.valueString - 1];
-        formatAppend(result, ".%.*s", int(str->len), str->data);
-      }
+        result.append('.').append(bytecode.string(constants[id1].valueString));
 
       if (count > 2)
-      {
-        const Constant &id = constants[id2];
-        // LUAU_ASSERT(id.type == Constant::Type_String && id.valueString <= debugStrings.size());
-
-        const TString *str = string_table.data[id.valueString - 1];
-        formatAppend(result, ".%.*s", int(str->len), str->data);
-      }
+        result.append('.').append(bytecode.string(constants[id2].valueString));
     }
     break;
   }
   case Constant::Type_Table:
-    formatAppend(result, "{...}");
+    result.append("{...}");
     break;
   case Constant::Type_Closure:
   {
-    const Proto *func = protos.data[data.valueClosure];
-    const auto debug_name = ([&]()
-                             {
-            if (func->debugname == nullptr || func->debugname->len == 0) {
-                return std::string("");
-            }
+    if (data.valueClosure >= bytecode.functions.size())
+      break;
 
-            return std::string(func->debugname->data, func->debugname->len); })();
+    const std::string_view debug_name = bytecode.functions[data.valueClosure].debugname;
 
     if (!debug_name.empty())
-      formatAppend(result, "'%s'", debug_name.data());
+      result.append('\'').append(debug_name).append('\'');
     break;
   }
   }
 }
 
-void sld::dumpInstruction(TempBuffer<TString *> &string_table, const std::vector<Constant> &constants, TempBuffer<Proto *> &protos, const uint32_t *code, std::string &result, int targetLabel)
+// constants are copied from the text rendered the first time an instruction refers to them, which spares loops that
+// name the same import or number over and over from formatting it again; only the counts are kept per thread
+static thread_local sld::ConstantTextStats constant_text_counts;
+
+// what an emitter needs to know about the instruction it is printing
+struct InstructionContext
 {
-  uint32_t insn = *code++;
+  const Bytecode &bytecode;
+  const Function &function;
+  const uint32_t *code;
+  int targetLabel;
+  int label;
+
+  // the rendered constants of `function` and where each one is, when dumping it as a whole; otherwise null
+  Writer *constants = nullptr;
+  sld::FunctionScratch::ConstantSpan *spans = nullptr;
+};
 
-  switch (LUAU_INSN_OP(insn))
+static void emitConstant(const InstructionContext &context, Writer &result, int k)
+{
+  if (context.constants == nullptr || k < 0 || uint32_t(k) >= context.function.sizek)
   {
-  case LOP_NOP:
-    formatAppend(result, "NOP\n");
-    break;
-  case LOP_LOADNIL:
-    formatAppend(result, "LOADNIL R%d\n", LUAU_INSN_A(insn));
-    break;
-
-  case LOP_LOADB:
-    if (LUAU_INSN_C(insn))
-      formatAppend(result, "LOADB R%d %d +%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    else
-      formatAppend(result, "LOADB R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
-
-  case LOP_LOADN:
-    formatAppend(result, "LOADN R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    break;
-
-  case LOP_LOADK:
-    formatAppend(result, "LOADK R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_D(insn));
-    result.append("]\n");
-    break;
-
-  case LOP_MOVE:
-    formatAppend(result, "MOVE R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
-
-  case LOP_GETGLOBAL:
-    formatAppend(result, "GETGLOBAL R%d K%d [", LUAU_INSN_A(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
-
-  case LOP_SETGLOBAL:
-    formatAppend(result, "SETGLOBAL R%d K%d [", LUAU_INSN_A(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
-
-  case LOP_GETUPVAL:
-    formatAppend(result, "GETUPVAL R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
-
-  case LOP_SETUPVAL:
-    formatAppend(result, "SETUPVAL R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
-
-  case LOP_CLOSEUPVALS:
-    formatAppend(result, "CLOSEUPVALS R%d\n", LUAU_INSN_A(insn));
-    break;
-
-  case LOP_GETIMPORT:
-    formatAppend(result, "GETIMPORT R%d %d [", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_D(insn));
-    result.append("]\n");
-    code++; // AUX
-    break;
-
-  case LOP_GETTABLE:
-    formatAppend(result, "GETTABLE R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
-
-  case LOP_SETTABLE:
-    formatAppend(result, "SETTABLE R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
-
-  case LOP_GETTABLEKS:
-    formatAppend(result, "GETTABLEKS R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
-
-  case LOP_SETTABLEKS:
-    formatAppend(result, "SETTABLEKS R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
-
-  case LOP_GETTABLEN:
-    formatAppend(result, "GETTABLEN R%d R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn) + 1);
-    break;
-
-  case LOP_SETTABLEN:
-    formatAppend(result, "SETTABLEN R%d R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn) + 1);
-    break;
-
-  case LOP_NEWCLOSURE:
-    formatAppend(result, "NEWCLOSURE R%d P%d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    break;
-
-  case LOP_NAMECALL:
-    formatAppend(result, "NAMECALL R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
-
-  case LOP_CALL:
-    formatAppend(result, "CALL R%d %d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn) - 1, LUAU_INSN_C(insn) - 1);
-    break;
-
-  case LOP_RETURN:
-    formatAppend(result, "RETURN R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn) - 1);
-    break;
-
-  case LOP_JUMP:
-    formatAppend(result, "JUMP L%d\n", targetLabel);
-    break;
-
-  case LOP_JUMPIF:
-    formatAppend(result, "JUMPIF R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
-
-  case LOP_JUMPIFNOT:
-    formatAppend(result, "JUMPIFNOT R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
-
-  case LOP_JUMPIFEQ:
-    formatAppend(result, "JUMPIFEQ R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
+    dumpConstant(context.bytecode, context.function, result, k);
+    return;
+  }
 
-  case LOP_JUMPIFLE:
-    formatAppend(result, "JUMPIFLE R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
+  Writer &texts = *context.constants;
+  sld::FunctionScratch::ConstantSpan &span = context.spans[k];
 
-  case LOP_JUMPIFLT:
-    formatAppend(result, "JUMPIFLT R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
-
-  case LOP_JUMPIFNOTEQ:
-    formatAppend(result, "JUMPIFNOTEQ R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
+  if (span.offset == sld::FunctionScratch::unrendered)
+  {
+    span.offset = uint32_t(texts.size());
+    dumpConstant(context.bytecode, context.function, texts, k);
+    span.length = uint32_t(texts.size() - span.offset);
 
-  case LOP_JUMPIFNOTLE:
-    formatAppend(result, "JUMPIFNOTLE R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
+    constant_text_counts.misses++;
+  }
+  else
+  {
+    constant_text_counts.hits++;
+  }
 
-  case LOP_JUMPIFNOTLT:
-    formatAppend(result, "JUMPIFNOTLT R%d R%d L%d\n", LUAU_INSN_A(insn), *code++, targetLabel);
-    break;
+  result.append(texts.view().substr(span.offset, span.length));
+}
 
-  case LOP_ADD:
-    formatAppend(result, "ADD R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+template <sld::Operand operand>
+static void emitOperand(const InstructionContext &context, Writer &result)
+{
+  using sld::Operand;
 
-  case LOP_SUB:
-    formatAppend(result, "SUB R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  const uint32_t insn = context.code[0];
 
-  case LOP_MUL:
-    formatAppend(result, "MUL R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  if constexpr (operand == Operand::None)
+    return;
+  else if constexpr (operand == Operand::RegA)
+    result.append(" R").integer(LUAU_INSN_A(insn));
+  else if constexpr (operand == Operand::RegB)
+    result.append(" R").integer(LUAU_INSN_B(insn));
+  else if constexpr (operand == Operand::RegC)
+    result.append(" R").integer(LUAU_INSN_C(insn));
+  else if constexpr (operand == Operand::RegAux)
+    result.append(" R").integer(context.code[1]);
+  else if constexpr (operand == Operand::RegAuxPair)
+    result.append(" R").integer(context.code[1] & 0xff).append(" R").integer((context.code[1] >> 8) & 0xff);
+  else if constexpr (operand == Operand::A)
+    result.append(' ').integer(LUAU_INSN_A(insn));
+  else if constexpr (operand == Operand::B)
+    result.append(' ').integer(LUAU_INSN_B(insn));
+  else if constexpr (operand == Operand::D)
+    result.append(' ').integer(LUAU_INSN_D(insn));
+  else if constexpr (operand == Operand::Aux)
+    result.append(' ').integer(context.code[1]);
+  else if constexpr (operand == Operand::BMinusOne)
+    result.append(' ').integer(LUAU_INSN_B(insn) - 1);
+  else if constexpr (operand == Operand::CMinusOne)
+    result.append(' ').integer(LUAU_INSN_C(insn) - 1);
+  else if constexpr (operand == Operand::CPlusOne)
+    result.append(' ').integer(LUAU_INSN_C(insn) + 1);
+  else if constexpr (operand == Operand::TableSize)
+    // shift counts past 31 wrap like they do for the VM's own shift on x86 instead of being undefined
+    result.append(' ').integer(LUAU_INSN_B(insn) == 0 ? 0 : int32_t(1u << ((LUAU_INSN_B(insn) - 1) & 31)));
+  else if constexpr (operand == Operand::AuxBool)
+    result.append(' ').integer(context.code[1] & 1);
+  else if constexpr (operand == Operand::AuxByte)
+    result.append(' ').integer(uint8_t(context.code[1]));
+  else if constexpr (operand == Operand::ConstantB)
+  {
+    result.append(" K").integer(LUAU_INSN_B(insn)).append(" [");
+    emitConstant(context, result, LUAU_INSN_B(insn));
+    result.append(']');
+  }
+  else if constexpr (operand == Operand::ConstantC)
+    result.append(" K").integer(LUAU_INSN_C(insn));
+  else if constexpr (operand == Operand::ConstantD)
+    result.append(" K").integer(LUAU_INSN_D(insn));
+  else if constexpr (operand == Operand::ConstantAux)
+    result.append(" K").integer(context.code[1]);
+  else if constexpr (operand == Operand::ConstantAuxLow)
+    result.append(" K").integer(context.code[1] & 0xffffff);
+  else if constexpr (operand == Operand::ImportD)
+    result.append(' ').integer(LUAU_INSN_D(insn));
+  else if constexpr (operand == Operand::ProtoD)
+    result.append(" P").integer(LUAU_INSN_D(insn));
+  else if constexpr (operand == Operand::Label)
+    result.append(" L").integer(context.targetLabel);
+  else if constexpr (operand == Operand::SkipC)
+  {
+    if (LUAU_INSN_C(insn))
+      result.append(" +").integer(LUAU_INSN_C(insn));
+  }
+  else if constexpr (operand == Operand::AuxNot)
+  {
+    if (context.code[1] >> 31)
+      result.append(" NOT");
+  }
+  else if constexpr (operand == Operand::AuxInext)
+  {
+    if (int(context.code[1]) < 0)
+      result.append(" [inext]");
+  }
+  else if constexpr (operand == Operand::AuxList)
+    result.append(" [").integer(context.code[1]).append(']');
+  else if constexpr (operand == Operand::Capture)
+  {
+    result.append(LUAU_INSN_A(insn) == LCT_UPVAL ? " UPVAL"
+                  : LUAU_INSN_A(insn) == LCT_REF ? " REF"
+                  : LUAU_INSN_A(insn) == LCT_VAL ? " VAL"
+                                                 : " ")
+        .append(' ')
+        .append(LUAU_INSN_A(insn) == LCT_UPVAL ? 'U' : 'R')
+        .integer(LUAU_INSN_B(insn));
+  }
+  else
+    static_assert(operand == Operand::None, "Unhandled operand kind");
+}
 
-  case LOP_DIV:
-    formatAppend(result, "DIV R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+// index of the constant printed after the operands, for opcodes where trailing_constant() holds
+template <uint8_t op>
+static int trailingConstant(const InstructionContext &context)
+{
+  using sld::Operand;
 
-  case LOP_IDIV:
-    formatAppend(result, "IDIV R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  constexpr auto &operands = sld::opcodes[op].operands;
 
-  case LOP_MOD:
-    formatAppend(result, "MOD R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  for (auto operand : operands)
+  {
+    switch (operand)
+    {
+    case Operand::ConstantC:
+      return LUAU_INSN_C(context.code[0]);
+    case Operand::ConstantD:
+    case Operand::ImportD:
+      return LUAU_INSN_D(context.code[0]);
+    case Operand::ConstantAux:
+      return context.code[1];
+    case Operand::ConstantAuxLow:
+      return context.code[1] & 0xffffff;
+    default:
+      break;
+    }
+  }
 
-  case LOP_POW:
-    formatAppend(result, "POW R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  return -1;
+}
 
-  case LOP_ADDK:
-    formatAppend(result, "ADDK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
+template <uint8_t op, size_t... index>
+static void emitOperands(const InstructionContext &context, Writer &result, std::index_sequence<index...>)
+{
+  (emitOperand<sld::opcodes[op].operands[index]>(context, result), ...);
+}
 
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+// one instantiation per opcode, the operand layout is resolved at compile time
+template <uint8_t op>
+static void emitInstruction(const InstructionContext &context, Writer &result)
+{
+  constexpr sld::OpcodeInfo info = sld::opcodes[op];
 
-  case LOP_SUBK:
+  if constexpr (!info.name.empty())
+  {
+    // lines are started rather than terminated by a newline so that the listing never ends in whitespace
+    result.append('\n');
 
-    formatAppend(result, "SUBK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+    if (context.label >= 0)
+      result.append('L').integer(context.label).append(": ");
 
-  case LOP_MULK:
+    result.append(info.name);
+    emitOperands<op>(context, result, std::make_index_sequence<sld::max_operands>{});
 
-    formatAppend(result, "MULK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+    if constexpr (info.trailing_constant())
+    {
+      result.append(" [");
+      emitConstant(context, result, trailingConstant<op>(context));
+      result.append(']');
+    }
+  }
+}
 
-  case LOP_DIVK:
+using InstructionEmitter = void (*)(const InstructionContext &, Writer &);
 
-    formatAppend(result, "DIVK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+template <size_t... op>
+static constexpr std::array<InstructionEmitter, sizeof...(op)> makeEmitters(std::index_sequence<op...>)
+{
+  return {&emitInstruction<uint8_t(op)>...};
+}
 
-  case LOP_IDIVK:
+static constexpr auto emitters = makeEmitters(std::make_index_sequence<sld::opcodes.size()>{});
 
-    formatAppend(result, "IDIVK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+void sld::dumpInstruction(const Bytecode &bytecode, const Function &function, const uint32_t *code, Writer &result, int targetLabel, int label)
+{
+  const InstructionContext context{bytecode, function, code, targetLabel, label};
 
-  case LOP_MODK:
+  emitters[LUAU_INSN_OP(*code)](context, result);
+}
 
-    formatAppend(result, "MODK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+sld::ConstantTextStats sld::constant_text_stats()
+{
+  return constant_text_counts;
+}
 
-  case LOP_POWK:
+size_t sld::FunctionScratch::retained_bytes() const
+{
+  return targets.retained_bytes() + constant_text.capacity() + constant_spans.capacity() * sizeof(ConstantSpan);
+}
 
-    formatAppend(result, "POWK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+void sld::dumpFunction(const Bytecode &bytecode, const Function &function, Writer &result)
+{
+  FunctionScratch scratch;
+  dumpFunction(bytecode, function, result, scratch);
+}
 
-  case LOP_SUBRK:
-    formatAppend(result, "SUBRK R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_B(insn));
-    formatAppend(result, "] R%d\n", LUAU_INSN_C(insn));
-    break;
+void sld::dumpFunction(const Bytecode &bytecode, const Function &function, Writer &result, FunctionScratch &scratch)
+{
+  result.append('[').append(function.debugname.empty() ? std::string_view("__unnamed_function__") : function.debugname).append(']');
 
-  case LOP_DIVRK:
-    formatAppend(result, "DIVRK R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_B(insn));
-    formatAppend(result, "] R%d\n", LUAU_INSN_C(insn));
-    break;
+  const uint32_t *code = bytecode.code_of(function);
 
-  case LOP_AND:
-    formatAppend(result, "AND R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  // labels are numbered in code order, so every target is known before the first instruction is printed
+  PcSet &targets = scratch.targets;
+  sld::find_jump_targets(bytecode, function, targets);
 
-  case LOP_OR:
-    formatAppend(result, "OR R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+  scratch.constant_text.clear();
+  scratch.constant_spans.assign(function.sizek, {FunctionScratch::unrendered, 0});
 
-  case LOP_ANDK:
-    formatAppend(result, "ANDK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+  Writer texts(scratch.constant_text);
 
-  case LOP_ORK:
-    formatAppend(result, "ORK R%d R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_C(insn));
-    result.append("]\n");
-    break;
+  for (uint32_t j = 0; j < function.sizecode;)
+  {
+    uint8_t op = LUAU_INSN_OP(code[j]);
 
-  case LOP_CONCAT:
-    formatAppend(result, "CONCAT R%d R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn));
-    break;
+    if (op == LOP_PREPVARARGS)
+    {
+      // Don't emit function header in bytecode - it's used for call dispatching and doesn't contain "interesting" information
+      j++;
+      continue;
+    }
 
-  case LOP_NOT:
-    formatAppend(result, "NOT R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
+    const InstructionContext context{bytecode, function, &code[j], targets.rank(sld::jump_target(code[j], j)), targets.rank(int32_t(j)), &texts, scratch.constant_spans.data()};
 
-  case LOP_MINUS:
-    formatAppend(result, "MINUS R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
+    emitters[op](context, result);
+    j += Luau::getOpLength(LuauOpcode(op));
+  }
+}
 
-  case LOP_LENGTH:
-    formatAppend(result, "LENGTH R%d R%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn));
-    break;
+// below this many functions the pool hand-off costs more than formatting them serially
+static constexpr size_t parallel_function_threshold = 64;
 
-  case LOP_NEWTABLE:
-    formatAppend(result, "NEWTABLE R%d %d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn) == 0 ? 0 : 1 << (LUAU_INSN_B(insn) - 1), *code++);
-    break;
+// functions formatted by one pool task into its own buffer
+static constexpr size_t parallel_slice_functions = 16;
 
-  case LOP_DUPTABLE:
-    formatAppend(result, "DUPTABLE R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    break;
+// slices per pool thread formatted before they are joined into the output; bounds the memory held in slices when
+// streaming to a sink
+static constexpr size_t parallel_slices_per_thread = 8;
 
-  case LOP_SETLIST:
-    formatAppend(result, "SETLIST R%d R%d %d [%d]\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), LUAU_INSN_C(insn) - 1, *code++);
-    break;
+size_t sld::DumpScratch::retained_bytes() const
+{
+  size_t bytes = function.retained_bytes() + tasks.capacity() * sizeof(FunctionScratch) + slices.capacity() * sizeof(std::string);
 
-  case LOP_FORNPREP:
-    formatAppend(result, "FORNPREP R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  for (const FunctionScratch &task : tasks)
+    bytes += task.retained_bytes();
 
-  case LOP_FORNLOOP:
-    formatAppend(result, "FORNLOOP R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  for (const std::string &slice : slices)
+    bytes += slice.capacity();
 
-  case LOP_FORGPREP:
-    formatAppend(result, "FORGPREP R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  return bytes;
+}
 
-  case LOP_FORGLOOP:
-    formatAppend(result, "FORGLOOP R%d L%d %d%s\n", LUAU_INSN_A(insn), targetLabel, uint8_t(*code), int(*code) < 0 ? " [inext]" : "");
-    code++;
-    break;
+void sld::dumpBytecode(const Bytecode &bytecode, Writer &result, DumpScratch &scratch, bool parallel, ThreadPool *pool)
+{
+  const size_t function_count = bytecode.functions.size();
 
-  case LOP_FORGPREP_INEXT:
-    formatAppend(result, "FORGPREP_INEXT R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  // the shared pool is only looked up for a parallel dump, the first lookup starts its threads
+  if (!parallel || function_count < parallel_function_threshold)
+    pool = nullptr;
+  else if (pool == nullptr)
+    pool = &ThreadPool::shared();
 
-  case LOP_FORGPREP_NEXT:
-    formatAppend(result, "FORGPREP_NEXT R%d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  if (pool == nullptr || pool->size() == 0)
+  {
+    for (size_t i = 0; i < function_count && !result.cancelled(); ++i)
+    {
+      if (i != 0)
+        result.append("\n\n");
 
-  case LOP_GETVARARGS:
-    formatAppend(result, "GETVARARGS R%d %d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn) - 1);
-    break;
+      dumpFunction(bytecode, bytecode.functions[i], result, scratch.function);
+    }
 
-  case LOP_DUPCLOSURE:
-    formatAppend(result, "DUPCLOSURE R%d K%d [", LUAU_INSN_A(insn), LUAU_INSN_D(insn));
-    dumpConstant(string_table, constants, protos, result, LUAU_INSN_D(insn));
-    result.append("]\n");
-    break;
+    return;
+  }
 
-  case LOP_BREAK:
-    formatAppend(result, "BREAK\n");
-    break;
+  // every function's text only depends on the shared string table and its own constants, so contiguous slices
+  // can be formatted independently and joined in order afterwards
+  const size_t slice_count = (function_count + parallel_slice_functions - 1) / parallel_slice_functions;
+  const size_t round_size = (pool->size() + 1) * parallel_slices_per_thread;
 
-  case LOP_JUMPBACK:
-    formatAppend(result, "JUMPBACK L%d\n", targetLabel);
-    break;
+  // kept by the caller's scratch, so repeated calls format into warm memory
+  auto &slices = scratch.slices;
 
-  case LOP_LOADKX:
-    formatAppend(result, "LOADKX R%d K%d [", LUAU_INSN_A(insn), *code);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
+  if (slices.size() < std::min(slice_count, round_size))
+    slices.resize(std::min(slice_count, round_size));
 
-  case LOP_JUMPX:
-    formatAppend(result, "JUMPX L%d\n", targetLabel);
-    break;
+  // one task per thread that can take part, each formatting the next unclaimed slice with its own function scratch
+  const size_t task_count = std::min(pool->size() + 1, slice_count);
 
-  case LOP_FASTCALL:
-    formatAppend(result, "FASTCALL %d L%d\n", LUAU_INSN_A(insn), targetLabel);
-    break;
+  if (scratch.tasks.size() < task_count)
+    scratch.tasks.resize(task_count);
 
-  case LOP_FASTCALL1:
-    formatAppend(result, "FASTCALL1 %d R%d L%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), targetLabel);
-    break;
+  for (size_t round = 0; round < slice_count && !result.cancelled(); round += round_size)
+  {
+    const size_t round_slices = std::min(round_size, slice_count - round);
+    std::atomic<size_t> next_slice{0};
 
-  case LOP_FASTCALL2:
-    formatAppend(result, "FASTCALL2 %d R%d R%d L%d\n", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code, targetLabel);
-    code++;
-    break;
+    pool->parallel_for(std::min(task_count, round_slices), [&](size_t task)
+                       {
+      FunctionScratch &function_scratch = scratch.tasks[task];
 
-  case LOP_FASTCALL2K:
-    formatAppend(result, "FASTCALL2K %d R%d K%d L%d [", LUAU_INSN_A(insn), LUAU_INSN_B(insn), *code, targetLabel);
-    dumpConstant(string_table, constants, protos, result, *code);
-    result.append("]\n");
-    code++;
-    break;
+      for (size_t index = next_slice++; index < round_slices; index = next_slice++)
+      {
+        const size_t begin = (round + index) * parallel_slice_functions;
+        const size_t end = std::min(begin + parallel_slice_functions, function_count);
 
-  case LOP_COVERAGE:
-    formatAppend(result, "COVERAGE\n");
-    break;
+        slices[index].clear();
+        Writer writer(slices[index]);
 
-  case LOP_CAPTURE:
-    formatAppend(result, "CAPTURE %s %c%d\n",
-                 LUAU_INSN_A(insn) == LCT_UPVAL ? "UPVAL"
-                 : LUAU_INSN_A(insn) == LCT_REF ? "REF"
-                 : LUAU_INSN_A(insn) == LCT_VAL ? "VAL"
-                                                : "",
-                 LUAU_INSN_A(insn) == LCT_UPVAL ? 'U' : 'R', LUAU_INSN_B(insn));
-    break;
+        for (size_t i = begin; i < end; ++i)
+        {
+          if (i != 0)
+            writer.append("\n\n");
 
-  case LOP_JUMPXEQKNIL:
-    formatAppend(result, "JUMPXEQKNIL R%d L%d%s\n", LUAU_INSN_A(insn), targetLabel, *code >> 31 ? " NOT" : "");
-    code++;
-    break;
+          dumpFunction(bytecode, bytecode.functions[i], writer, function_scratch);
+        }
+      } });
 
-  case LOP_JUMPXEQKB:
-    formatAppend(result, "JUMPXEQKB R%d %d L%d%s\n", LUAU_INSN_A(insn), *code & 1, targetLabel, *code >> 31 ? " NOT" : "");
-    code++;
-    break;
+    for (size_t index = 0; index < round_slices; ++index)
+    {
+      result.append(slices[index]);
+    }
+  }
+}
 
-  case LOP_JUMPXEQKN:
-    formatAppend(result, "JUMPXEQKN R%d K%d L%d%s [", LUAU_INSN_A(insn), *code & 0xffffff, targetLabel, *code >> 31 ? " NOT" : "");
-    dumpConstant(string_table, constants, protos, result, *code & 0xffffff);
-    result.append("]\n");
-    code++;
-    break;
+void sld::dumpBytecode(const Bytecode &bytecode, Writer &result, bool parallel, ThreadPool *pool)
+{
+  DumpScratch scratch;
+  dumpBytecode(bytecode, result, scratch, parallel, pool);
+}
 
-  case LOP_JUMPXEQKS:
-    formatAppend(result, "JUMPXEQKS R%d K%d L%d%s [", LUAU_INSN_A(insn), *code & 0xffffff, targetLabel, *code >> 31 ? " NOT" : "");
-    dumpConstant(string_table, constants, protos, result, *code & 0xffffff);
-    result.append("]\n");
-    code++;
-    break;
-  case LOP_PREPVARARGS:
-    formatAppend(result, "PREPVARARGS R%d\n", LUAU_INSN_A(insn));
-    code++;
-    break;
-  default:
-    LUAU_ASSERT(!"Unsupported opcode");
-  }
+void sld::dumpBytecode(const Bytecode &bytecode, std::string &result, bool parallel, ThreadPool *pool)
+{
+  Writer writer(result);
+  dumpBytecode(bytecode, writer, parallel, pool);
 }
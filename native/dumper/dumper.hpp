@@ -1,69 +1,66 @@
 #pragma once
 
-#include <lobject.h>
-#include <lmem.h>
-
-#include <vector>
+#include <cstdint>
 #include <string>
+#include <vector>
+
+#include "../analysis/analysis.hpp"
+#include "../bytecode/bytecode.hpp"
+#include "writer.hpp"
 
 namespace sld
 {
-  template <typename T>
-  struct TempBuffer
-  {
-    lua_State *L;
-    T *data;
-    size_t count;
+  class ThreadPool;
 
-    TempBuffer(lua_State *L, size_t count)
-        : L(L), data(luaM_newarray(L, count, T, 0)), count(count)
-    {
-    }
+  // `targetLabel` is printed for branch operands, `label` (unless -1) in front of the instruction
+  void dumpInstruction(const Bytecode &bytecode, const Function &function, const uint32_t *code, Writer &result, int targetLabel, int label = -1);
+  // how often dumpFunction reused the text of a constant it had already rendered for the same function; counted per
+  // thread
+  struct ConstantTextStats
+  {
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+  };
 
-    TempBuffer(const TempBuffer &) = delete;
-    TempBuffer(TempBuffer &&) = delete;
+  ConstantTextStats constant_text_stats();
 
-    TempBuffer &operator=(const TempBuffer &) = delete;
-    TempBuffer &operator=(TempBuffer &&) = delete;
+  // what dumpFunction reuses from one function to the next: the jump targets of the function being dumped, the text
+  // of its constants, each rendered the first time an instruction refers to it, and where each one is in it
+  struct FunctionScratch
+  {
+    static constexpr uint32_t unrendered = UINT32_MAX;
 
-    ~TempBuffer() noexcept
+    struct ConstantSpan
     {
-      luaM_freearray(L, data, count, T, 0);
-    }
+      uint32_t offset;
+      uint32_t length;
+    };
 
-    T &operator[](size_t index)
-    {
-      LUAU_ASSERT(index < count);
-      return data[index];
-    }
+    PcSet targets;
+    std::string constant_text;
+    std::vector<ConstantSpan> constant_spans;
+
+    size_t retained_bytes() const;
   };
 
-  struct Constant
+  void dumpFunction(const Bytecode &bytecode, const Function &function, Writer &result, FunctionScratch &scratch);
+  // with scratch of its own, for one-off dumps
+  void dumpFunction(const Bytecode &bytecode, const Function &function, Writer &result);
+  // what dumpBytecode reuses from one call to the next: the calling thread's function scratch, one more for every
+  // task of a parallel dump and the slices those format into before they are joined. A Disassembler owns one, so
+  // its retained-bytes limit and reset() cover it
+  struct DumpScratch
   {
-    enum Type
-    {
-      Type_Nil,
-      Type_Boolean,
-      Type_Number,
-      Type_Vector,
-      Type_String,
-      Type_Import,
-      Type_Table,
-      Type_Closure,
-    };
+    FunctionScratch function;
+    std::vector<FunctionScratch> tasks;
+    std::vector<std::string> slices;
 
-    Type type;
-    union
-    {
-      bool valueBoolean;
-      double valueNumber;
-      float valueVector[4];
-      unsigned int valueString; // index into string table
-      uint32_t valueImport;     // 10-10-10-2 encoded import id
-      uint32_t valueTable;      // index into tableShapes[]
-      uint32_t valueClosure;    // index of function in global list
-    };
+    size_t retained_bytes() const;
   };
 
-  void dumpInstruction(TempBuffer<TString *> &string_table, const std::vector<Constant> &constants, TempBuffer<Proto *> &protos, const uint32_t *code, std::string &result, int targetLabel);
+  // a parallel dump splits the functions across `pool`, or the shared pool when it is null
+  void dumpBytecode(const Bytecode &bytecode, Writer &result, DumpScratch &scratch, bool parallel = false, ThreadPool *pool = nullptr);
+  // with scratch of its own, for one-off dumps
+  void dumpBytecode(const Bytecode &bytecode, Writer &result, bool parallel = false, ThreadPool *pool = nullptr);
+  void dumpBytecode(const Bytecode &bytecode, std::string &result, bool parallel = false, ThreadPool *pool = nullptr);
 }
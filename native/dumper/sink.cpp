@@ -0,0 +1,35 @@
+#include "sink.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <cerrno>
+#include <unistd.h>
+#endif
+
+void sld::FileSink::write(std::string_view chunk)
+{
+  while (!failed && !chunk.empty())
+  {
+#ifdef _WIN32
+    const int written = ::_write(fd, chunk.data(), unsigned(std::min<size_t>(chunk.size(), 1u << 30)));
+#else
+    const ssize_t written = ::write(fd, chunk.data(), chunk.size());
+
+    if (written < 0 && errno == EINTR)
+    {
+      continue;
+    }
+#endif
+
+    if (written <= 0)
+    {
+      failed = true;
+      break;
+    }
+
+    chunk.remove_prefix(size_t(written));
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace sld
+{
+  // receives the listing in chunks as it is produced, so it never has to exist in memory as a whole
+  class Sink
+  {
+  public:
+    virtual ~Sink() = default;
+
+    virtual void write(std::string_view chunk) = 0;
+
+    // true once the receiver gave up on the rest of the listing; formatting stops at the next function
+    virtual bool cancelled() const
+    {
+      return false;
+    }
+  };
+
+  class StringSink : public Sink
+  {
+  public:
+    explicit StringSink(std::string &output)
+        : output(output)
+    {
+    }
+
+    void write(std::string_view chunk) override
+    {
+      output.append(chunk);
+    }
+
+  private:
+    std::string &output;
+  };
+
+  // writes to an already open file descriptor, which stays owned by the caller
+  class FileSink : public Sink
+  {
+  public:
+    explicit FileSink(int fd)
+        : fd(fd)
+    {
+    }
+
+    void write(std::string_view chunk) override;
+
+    // false once a write failed, everything after that is dropped
+    bool ok() const
+    {
+      return !failed;
+    }
+
+  private:
+    int fd;
+    bool failed = false;
+  };
+}
@@ -0,0 +1,172 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "sink.hpp"
+
+namespace sld
+{
+  // append-only text writer over a std::string; the string is grown geometrically ahead of the cursor and trimmed
+  // to the written length by finish() (or the destructor), so individual appends are a bounds check and a copy.
+  // When writing to a sink, the text is collected in an internal buffer that is handed over in chunks instead
+  class Writer
+  {
+  public:
+    static constexpr size_t default_chunk_size = 64 * 1024;
+
+    explicit Writer(std::string &output)
+        : output(output), length(output.size())
+    {
+    }
+
+    explicit Writer(Sink &sink, size_t chunk_size = default_chunk_size)
+        : output(buffer), length(0), sink(&sink), chunk_size(chunk_size)
+    {
+      buffer.resize(chunk_size);
+    }
+
+    Writer(const Writer &) = delete;
+    Writer &operator=(const Writer &) = delete;
+
+    ~Writer()
+    {
+      finish();
+    }
+
+    Writer &append(std::string_view text)
+    {
+      // large blocks (such as pre-formatted slices) go to the sink as they are instead of through the buffer
+      if (sink != nullptr && text.size() >= chunk_size)
+      {
+        flush();
+        sink->write(text);
+
+        return *this;
+      }
+
+      // empty views may carry a null pointer, which memcpy doesn't accept even for zero bytes
+      if (text.empty())
+        return *this;
+
+      memcpy(reserve(text.size()), text.data(), text.size());
+      length += text.size();
+
+      return *this;
+    }
+
+    Writer &append(char c)
+    {
+      *reserve(1) = c;
+      length++;
+
+      return *this;
+    }
+
+    // same output as printf's %d, unsigned operands are reinterpreted the way %d would
+    Writer &integer(int32_t value)
+    {
+      char *out = reserve(11);
+      uint32_t magnitude = uint32_t(value);
+
+      if (value < 0)
+      {
+        *out++ = '-';
+        magnitude = 0u - magnitude;
+      }
+
+      char digits[10];
+      char *digit = digits + sizeof(digits);
+
+      do
+      {
+        *--digit = char('0' + magnitude % 10);
+        magnitude /= 10;
+      } while (magnitude != 0);
+
+      const size_t count = digits + sizeof(digits) - digit;
+      memcpy(out, digit, count);
+
+      length = (out - output.data()) + count;
+
+      return *this;
+    }
+
+    // same output as printf's %.<precision>g, in a single pass
+    Writer &number(double value, int precision)
+    {
+      // sign, 17 significant digits, point and a 5 character exponent fit with room to spare
+      constexpr size_t max_length = 32;
+
+      char *out = reserve(max_length);
+      const auto result = std::to_chars(out, out + max_length, value, std::chars_format::general, precision);
+
+      length += result.ptr - out;
+
+      return *this;
+    }
+
+    // length of the text written so far, not counting what was already handed to a sink
+    size_t size() const
+    {
+      return length;
+    }
+
+    // the text written so far; like size(), only what wasn't handed to a sink yet, and only valid until the next append
+    std::string_view view() const
+    {
+      return std::string_view(output.data(), length);
+    }
+
+    // whether the sink gave up on the rest of the text, never the case for strings
+    bool cancelled() const
+    {
+      return sink != nullptr && sink->cancelled();
+    }
+
+    // hands everything written so far to the sink; a no-op when writing to a string
+    void flush()
+    {
+      if (sink != nullptr && length != 0)
+      {
+        sink->write(std::string_view(output.data(), length));
+        length = 0;
+      }
+    }
+
+    // trims the string down to what was written, or flushes the remaining text to the sink
+    void finish()
+    {
+      if (sink != nullptr)
+        flush();
+      else
+        output.resize(length);
+    }
+
+  private:
+    char *reserve(size_t count)
+    {
+      if (length + count > output.size())
+      {
+        if (sink != nullptr && length + count > chunk_size)
+          flush();
+
+        if (length + count > output.size())
+          output.resize(std::max(output.size() * 2, length + count + 256));
+      }
+
+      return &output[length];
+    }
+
+    std::string buffer;
+    std::string &output;
+    size_t length;
+
+    Sink *sink = nullptr;
+    size_t chunk_size = 0;
+  };
+}
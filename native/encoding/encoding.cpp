@@ -0,0 +1,381 @@
+#include "encoding.hpp"
+#include "../bytecode/opcodes.hpp"
+
+#include <algorithm>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define SLD_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// gcc and clang only emit AVX2 for functions that ask for it, so the rest of the file still runs on any x86
+#if defined(SLD_X86) && (defined(__GNUC__) || defined(__clang__))
+#define SLD_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define SLD_TARGET_AVX2
+#endif
+
+using OpcodeDecoder = void (*)(uint32_t *, size_t, uint8_t);
+
+static void decode_opcodes_scalar(uint32_t *code, size_t count, uint8_t multiplier)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    code[i] = (code[i] & ~uint32_t(0xff)) | uint8_t(code[i] * multiplier);
+  }
+}
+
+#ifdef SLD_X86
+// the low 16 bits of every 32-bit lane are multiplied by the key and the high 16 bits by 0; only the low byte of the
+// product is kept, which is the opcode times the key mod 256 since the operand byte only contributes multiples of 256
+static void decode_opcodes_sse2(uint32_t *code, size_t count, uint8_t multiplier)
+{
+  const __m128i key = _mm_set1_epi32(multiplier);
+  const __m128i opcode_mask = _mm_set1_epi32(0xff);
+
+  size_t i = 0;
+
+  for (; i + 4 <= count; i += 4)
+  {
+    const __m128i words = _mm_loadu_si128(reinterpret_cast<const __m128i *>(code + i));
+    const __m128i opcodes = _mm_and_si128(_mm_mullo_epi16(words, key), opcode_mask);
+
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(code + i), _mm_or_si128(_mm_andnot_si128(opcode_mask, words), opcodes));
+  }
+
+  decode_opcodes_scalar(code + i, count - i, multiplier);
+}
+
+SLD_TARGET_AVX2 static void decode_opcodes_avx2(uint32_t *code, size_t count, uint8_t multiplier)
+{
+  const __m256i key = _mm256_set1_epi32(multiplier);
+  const __m256i opcode_mask = _mm256_set1_epi32(0xff);
+
+  size_t i = 0;
+
+  for (; i + 8 <= count; i += 8)
+  {
+    const __m256i words = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(code + i));
+    const __m256i opcodes = _mm256_and_si256(_mm256_mullo_epi16(words, key), opcode_mask);
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(code + i), _mm256_or_si256(_mm256_andnot_si256(opcode_mask, words), opcodes));
+  }
+
+  decode_opcodes_sse2(code + i, count - i, multiplier);
+}
+
+static bool cpu_has_avx2()
+{
+#ifdef _MSC_VER
+  int info[4];
+  __cpuid(info, 0);
+
+  if (info[0] < 7)
+    return false;
+
+  __cpuidex(info, 7, 0);
+
+  // the OS also has to save the upper halves of the ymm registers
+  return (info[1] & (1 << 5)) != 0 && (_xgetbv(0) & 6) == 6;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct OpcodeDecoderEntry
+{
+  OpcodeDecoder decode;
+  const char *name;
+};
+
+static const OpcodeDecoderEntry &opcode_decoder()
+{
+  static const OpcodeDecoderEntry decoder = []() -> OpcodeDecoderEntry
+  {
+#ifdef SLD_X86
+    if (cpu_has_avx2())
+      return {decode_opcodes_avx2, "avx2"};
+
+    // every x86-64 CPU has SSE2; 32-bit builds are assumed to target one as well
+    return {decode_opcodes_sse2, "sse2"};
+#else
+    return {decode_opcodes_scalar, "scalar"};
+#endif
+  }();
+
+  return decoder;
+}
+
+void sld::multiply_opcodes(uint32_t *code, size_t count, uint8_t multiplier)
+{
+  if (multiplier == 1)
+    return;
+
+  opcode_decoder().decode(code, count, multiplier);
+}
+
+const char *sld::opcode_decoder_name()
+{
+  return opcode_decoder().name;
+}
+
+struct EncodingScheme
+{
+  std::string name;
+
+  // used when there is no callback
+  uint8_t multiplier;
+  sld::OpcodeDecodeCallback decode;
+
+  // the opcode table of a scheme registered with one, in which case `decode` applies it
+  std::string table;
+};
+
+struct EncodingRegistry
+{
+  std::shared_mutex mutex;
+
+  // indexed by BytecodeEncoding; a deque keeps every scheme in place as it grows and schemes are never changed, so one
+  // can be used after the lock is released
+  std::deque<EncodingScheme> schemes{{"luau", 1, {}}, {"roblox", 203, {}}};
+};
+
+static EncodingRegistry &encoding_registry()
+{
+  static EncodingRegistry registry;
+  return registry;
+}
+
+static const EncodingScheme *find_scheme(sld::BytecodeEncoding encoding)
+{
+  auto &registry = encoding_registry();
+  std::shared_lock lock(registry.mutex);
+
+  return encoding < registry.schemes.size() ? &registry.schemes[encoding] : nullptr;
+}
+
+static size_t encoding_count()
+{
+  auto &registry = encoding_registry();
+  std::shared_lock lock(registry.mutex);
+
+  return registry.schemes.size();
+}
+
+static std::optional<sld::BytecodeEncoding> add_scheme(EncodingScheme scheme)
+{
+  if (scheme.name == "auto")
+    return {};
+
+  auto &registry = encoding_registry();
+  std::unique_lock lock(registry.mutex);
+
+  for (size_t i = 0; i < registry.schemes.size(); ++i)
+  {
+    const auto &existing = registry.schemes[i];
+
+    if (existing.name != scheme.name)
+      continue;
+
+    // callbacks can't be compared, registering one under a taken name always fails
+    if (!existing.decode && !scheme.decode && existing.multiplier == scheme.multiplier)
+      return sld::BytecodeEncoding(i);
+
+    if (!existing.table.empty() && existing.table == scheme.table)
+      return sld::BytecodeEncoding(i);
+
+    return {};
+  }
+
+  if (registry.schemes.size() >= sld::BytecodeEncoding::Auto)
+    return {};
+
+  registry.schemes.push_back(std::move(scheme));
+
+  return sld::BytecodeEncoding(registry.schemes.size() - 1);
+}
+
+std::optional<sld::BytecodeEncoding> sld::register_encoding(std::string name, uint8_t multiplier)
+{
+  // an even multiplier maps two opcodes to the same byte, so it can't undo anything
+  if (multiplier % 2 == 0)
+    return {};
+
+  return add_scheme({std::move(name), multiplier, {}});
+}
+
+std::optional<sld::BytecodeEncoding> sld::register_encoding(std::string name, const std::array<uint8_t, 256> &table)
+{
+  auto decode = [table](uint32_t *code, size_t count)
+  {
+    for (size_t i = 0; i < count; ++i)
+      code[i] = (code[i] & ~uint32_t(0xff)) | table[code[i] & 0xff];
+  };
+
+  return add_scheme({std::move(name), 1, std::move(decode), std::string(table.begin(), table.end())});
+}
+
+std::optional<sld::BytecodeEncoding> sld::register_encoding(std::string name, OpcodeDecodeCallback decode)
+{
+  if (!decode)
+    return {};
+
+  return add_scheme({std::move(name), 1, std::move(decode)});
+}
+
+std::optional<sld::BytecodeEncoding> sld::find_encoding(std::string_view name)
+{
+  if (name == "auto")
+    return BytecodeEncoding::Auto;
+
+  auto &registry = encoding_registry();
+  std::shared_lock lock(registry.mutex);
+
+  for (size_t i = 0; i < registry.schemes.size(); ++i)
+  {
+    if (registry.schemes[i].name == name)
+      return BytecodeEncoding(i);
+  }
+
+  return {};
+}
+
+std::string sld::encoding_name(BytecodeEncoding encoding)
+{
+  if (encoding == BytecodeEncoding::Auto)
+    return "auto";
+
+  const EncodingScheme *scheme = find_scheme(encoding);
+
+  return scheme != nullptr ? scheme->name : std::string();
+}
+
+sld::EncodingIdentity sld::encoding_identity(BytecodeEncoding encoding)
+{
+  // schemes are only ever added, so their count tells every registry state that detection could pick from apart
+  if (encoding == BytecodeEncoding::Auto)
+    return {"auto:" + std::to_string(encoding_count()), false};
+
+  const EncodingScheme *scheme = find_scheme(encoding);
+
+  if (scheme == nullptr)
+    return {"unknown", false};
+
+  if (!scheme->table.empty())
+    return {"table:" + scheme->table, true};
+
+  if (scheme->decode)
+    return {"callback:" + std::to_string(encoding), false};
+
+  return {"multiply:" + std::to_string(scheme->multiplier), true};
+}
+
+bool sld::decode_opcodes(uint32_t *code, size_t count, BytecodeEncoding encoding)
+{
+  const EncodingScheme *scheme = find_scheme(encoding);
+
+  if (scheme == nullptr)
+    return false;
+
+  if (scheme->decode)
+    scheme->decode(code, count);
+  else
+    multiply_opcodes(code, count, scheme->multiplier);
+
+  return true;
+}
+
+// instructions decoded per function when detecting the encoding; enough to get past the entry sequence
+constexpr uint32_t detect_sample_size = 8;
+// functions looked at, spread evenly over the blob so that big bundles cost no more than small ones
+constexpr size_t detect_sample_functions = 64;
+
+sld::BytecodeEncoding sld::detect_encoding(const Bytecode &bytecode)
+{
+  thread_local std::vector<const Function *> functions;
+  thread_local std::vector<uint32_t> sample;
+  thread_local std::vector<uint32_t> decoded;
+
+  functions.clear();
+  sample.clear();
+
+  const size_t function_count = bytecode.functions.size();
+  const size_t stride = std::max<size_t>(1, function_count / detect_sample_functions);
+
+  for (size_t i = 0; i < function_count; i += stride)
+  {
+    functions.push_back(&bytecode.functions[i]);
+  }
+
+  // the main function is always vararg, which makes it the most telling one
+  if (bytecode.mainid < function_count && bytecode.mainid % stride != 0)
+    functions.push_back(&bytecode.functions[bytecode.mainid]);
+
+  for (const Function *function : functions)
+  {
+    const uint32_t *code = bytecode.code_of(*function);
+    sample.insert(sample.end(), code, code + std::min(function->sizecode, detect_sample_size));
+  }
+
+  const size_t count = encoding_count();
+
+  BytecodeEncoding best = BytecodeEncoding::Luau;
+  size_t best_errors = SIZE_MAX;
+  size_t best_valid = 0;
+
+  for (size_t id = 0; id < count; ++id)
+  {
+    const auto encoding = BytecodeEncoding(id);
+
+    decoded.assign(sample.begin(), sample.end());
+    decode_opcodes(decoded.data(), decoded.size(), encoding);
+
+    size_t errors = 0;
+    size_t valid = 0;
+    size_t offset = 0;
+
+    for (const Function *function : functions)
+    {
+      const uint32_t *code = decoded.data() + offset;
+      const uint32_t sampled = std::min(function->sizecode, detect_sample_size);
+
+      // the compiler opens every vararg function with PREPVARARGS over its fixed parameters
+      if (function->is_vararg && (sampled == 0 || LUAU_INSN_OP(code[0]) != LOP_PREPVARARGS || LUAU_INSN_A(code[0]) != function->numparams))
+        errors++;
+
+      for (uint32_t pc = 0; pc < sampled;)
+      {
+        const auto &info = opcodes[LUAU_INSN_OP(code[pc])];
+
+        // anything after an unknown opcode is misaligned, so the rest of the sample says nothing
+        if (info.name.empty())
+        {
+          errors++;
+          break;
+        }
+
+        valid++;
+        pc += info.aux ? 2 : 1;
+      }
+
+      offset += sampled;
+    }
+
+    if (errors < best_errors || (errors == best_errors && valid > best_valid))
+    {
+      best = encoding;
+      best_errors = errors;
+      best_valid = valid;
+    }
+  }
+
+  return best;
+}
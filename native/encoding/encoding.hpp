@@ -0,0 +1,60 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "../bytecode/bytecode.hpp"
+
+namespace sld
+{
+  // rewrites the opcode byte of `count` instructions in place; may be called from several threads at once
+  using OpcodeDecodeCallback = std::function<void(uint32_t *code, size_t count)>;
+
+  // replaces the opcode byte of every instruction with opcode * multiplier (mod 256), leaving the operands alone;
+  // vectorized where the CPU allows, the kernel is picked once at runtime
+  void multiply_opcodes(uint32_t *code, size_t count, uint8_t multiplier);
+
+  // kernel multiply_opcodes uses on this CPU: "avx2", "sse2" or "scalar"
+  const char *opcode_decoder_name();
+
+  // adds a scheme that multiplies every opcode by `multiplier` to decode it (an odd number, the inverse of the key
+  // the encoder used); returns the existing id when the same scheme is registered twice under one name, and nothing
+  // when the multiplier is even, the name is taken by a different scheme or is "auto", or the registry is full.
+  // Luau (multiplier 1) and Roblox (multiplier 203, the inverse of 227) are always registered
+  std::optional<BytecodeEncoding> register_encoding(std::string name, uint8_t multiplier);
+  // adds a scheme that maps every encoded opcode to table[opcode]; the same name can be registered twice only with
+  // the same table
+  std::optional<BytecodeEncoding> register_encoding(std::string name, const std::array<uint8_t, 256> &table);
+  // adds a scheme with its own decoding routine
+  std::optional<BytecodeEncoding> register_encoding(std::string name, OpcodeDecodeCallback decode);
+
+  std::optional<BytecodeEncoding> find_encoding(std::string_view name);
+  // empty for ids that aren't registered
+  std::string encoding_name(BytecodeEncoding encoding);
+
+  // what decoding under an encoding does, for keying results on it rather than on its name
+  struct EncodingIdentity
+  {
+    // the multiplier or opcode table of a scheme
+    std::string key;
+
+    // false when the key only holds in this process: for callbacks, which can't be told apart, and for Auto, whose
+    // pick changes as schemes are registered (its key holds how many there are)
+    bool portable = true;
+  };
+
+  EncodingIdentity encoding_identity(BytecodeEncoding encoding);
+
+  // decodes with a registered scheme, false if `encoding` isn't one
+  bool decode_opcodes(uint32_t *code, size_t count, BytecodeEncoding encoding);
+
+  // picks the registered scheme under which the still encoded code of `bytecode` looks most like real bytecode:
+  // only the first few instructions of every function are decoded, counting opcodes that don't exist and vararg
+  // functions that don't start with PREPVARARGS. Ties go to the lowest id, so plain Luau wins when nothing is wrong
+  BytecodeEncoding detect_encoding(const Bytecode &bytecode);
+}
@@ -0,0 +1,168 @@
+#include "mapped_file.hpp"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool fail(std::error_code *error, int code)
+{
+  if (error != nullptr)
+    *error = std::error_code(code, std::system_category());
+
+  return false;
+}
+
+sld::MappedFile::~MappedFile()
+{
+  close();
+}
+
+sld::MappedFile::MappedFile(MappedFile &&other) noexcept
+    : data(std::exchange(other.data, nullptr)), length(std::exchange(other.length, 0))
+{
+}
+
+sld::MappedFile &sld::MappedFile::operator=(MappedFile &&other) noexcept
+{
+  if (this != &other)
+  {
+    close();
+
+    data = std::exchange(other.data, nullptr);
+    length = std::exchange(other.length, 0);
+  }
+
+  return *this;
+}
+
+#ifdef _WIN32
+bool sld::MappedFile::open(const std::string &path, std::error_code *error)
+{
+  close();
+
+  // paths are utf-8, the ANSI functions would read them in the system code page
+  const int wide_length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+  std::wstring wide_path(size_t(wide_length), L'\0');
+  MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &wide_path[0], wide_length);
+
+  HANDLE file = CreateFileW(wide_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+
+  if (file == INVALID_HANDLE_VALUE)
+    return fail(error, int(GetLastError()));
+
+  LARGE_INTEGER file_size;
+
+  if (!GetFileSizeEx(file, &file_size))
+  {
+    const DWORD code = GetLastError();
+    CloseHandle(file);
+
+    return fail(error, int(code));
+  }
+
+  // empty files can't be mapped, an empty view says the same thing
+  if (file_size.QuadPart == 0)
+  {
+    CloseHandle(file);
+    return true;
+  }
+
+  HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  const DWORD mapping_error = GetLastError();
+  CloseHandle(file);
+
+  if (mapping == nullptr)
+    return fail(error, int(mapping_error));
+
+  // the view keeps the mapping alive on its own
+  const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+  const DWORD view_error = GetLastError();
+  CloseHandle(mapping);
+
+  if (view == nullptr)
+    return fail(error, int(view_error));
+
+  data = static_cast<const char *>(view);
+  length = size_t(file_size.QuadPart);
+
+  return true;
+}
+
+void sld::MappedFile::close()
+{
+  if (data != nullptr)
+    UnmapViewOfFile(data);
+
+  data = nullptr;
+  length = 0;
+}
+#else
+bool sld::MappedFile::open(const std::string &path, std::error_code *error)
+{
+  close();
+
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0)
+    return fail(error, errno);
+
+  struct stat info;
+
+  if (fstat(fd, &info) != 0)
+  {
+    const int code = errno;
+    ::close(fd);
+
+    return fail(error, code);
+  }
+
+  if (!S_ISREG(info.st_mode))
+  {
+    ::close(fd);
+    return fail(error, S_ISDIR(info.st_mode) ? EISDIR : EINVAL);
+  }
+
+  // empty files can't be mapped, an empty view says the same thing
+  if (info.st_size == 0)
+  {
+    ::close(fd);
+    return true;
+  }
+
+  void *view = mmap(nullptr, size_t(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+  const int code = errno;
+
+  // the mapping holds its own reference to the file
+  ::close(fd);
+
+  if (view == MAP_FAILED)
+    return fail(error, code);
+
+  // bytecode is read front to back once
+  madvise(view, size_t(info.st_size), MADV_SEQUENTIAL);
+
+  data = static_cast<const char *>(view);
+  length = size_t(info.st_size);
+
+  return true;
+}
+
+void sld::MappedFile::close()
+{
+  if (data != nullptr)
+    munmap(const_cast<char *>(data), length);
+
+  data = nullptr;
+  length = 0;
+}
+#endif
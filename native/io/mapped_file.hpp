@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+namespace sld
+{
+  // read-only view of a whole file; the file is mapped rather than read, so its pages are loaded on demand and never
+  // copied into the process. The view stays valid until the file is closed or another one is opened
+  class MappedFile
+  {
+  public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    // false if the file couldn't be opened or mapped, with the system's reason in `error` if given
+    bool open(const std::string &path, std::error_code *error = nullptr);
+    void close();
+
+    std::string_view view() const
+    {
+      return std::string_view(data, length);
+    }
+
+    size_t size() const
+    {
+      return length;
+    }
+
+  private:
+    const char *data = nullptr;
+    size_t length = 0;
+  };
+}
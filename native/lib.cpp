@@ -1,74 +1,1862 @@
 #include <node_api.h>
 
 #include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include <iostream>
 
+#include "analysis/analysis.hpp"
+#include "analysis/cfg.hpp"
+#include "cache/cache.hpp"
 #include "disassembler/disassembler.hpp"
+#include "encoding/encoding.hpp"
+#include "io/mapped_file.hpp"
+#include "pool/pool.hpp"
+
+static std::string get_string(napi_env env, napi_value value)
+{
+  size_t length = 0;
+  napi_get_value_string_utf8(env, value, nullptr, 0, &length);
+
+  std::string result(length, '\0');
+  napi_get_value_string_utf8(env, value, &result[0], result.length() + 1, nullptr);
+
+  return result;
+}
+
+static sld::BytecodeEncoding get_encoding(napi_env env, napi_value value)
+{
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+
+  if (type != napi_string)
+  {
+    return sld::BytecodeEncoding::Luau;
+  }
+
+  // names that aren't registered read the bytecode as plain Luau, like before encodings could be registered
+  return sld::find_encoding(get_string(env, value)).value_or(sld::BytecodeEncoding::Luau);
+}
+
+static bool get_bool_property(napi_env env, napi_value object, const char *name)
+{
+  napi_value value;
+  bool result = false;
+
+  napi_get_named_property(env, object, name, &value);
+  napi_coerce_to_bool(env, value, &value);
+  napi_get_value_bool(env, value, &result);
+
+  return result;
+}
+
+// accepts either the encoding name on its own or an options object
+static sld::DisassembleOptions get_options(napi_env env, napi_value value)
+{
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+
+  if (type != napi_object)
+  {
+    return sld::DisassembleOptions(get_encoding(env, value));
+  }
+
+  napi_value encoding;
+  napi_get_named_property(env, value, "encoding", &encoding);
+
+  sld::DisassembleOptions options(get_encoding(env, encoding));
+  options.parallel = get_bool_property(env, value, "parallel");
+
+  return options;
+}
+
+// a level property of a compile options object; absent ones keep their default, others must be 0, 1 or 2
+static bool get_level_property(napi_env env, napi_value object, const char *name, int &level)
+{
+  napi_value value;
+  napi_valuetype type;
+
+  napi_get_named_property(env, object, name, &value);
+  napi_typeof(env, value, &type);
+
+  if (type == napi_undefined)
+    return true;
+
+  double number = -1;
+
+  if (type == napi_number)
+    napi_get_value_double(env, value, &number);
+
+  if (number != 0 && number != 1 && number != 2)
+  {
+    napi_throw_range_error(env, nullptr, (std::string("Expected ") + name + " to be 0, 1 or 2").c_str());
+    return false;
+  }
+
+  level = int(number);
+  return true;
+}
+
+static bool get_string_property(napi_env env, napi_value object, const char *name, std::string &result)
+{
+  napi_value value;
+  napi_valuetype type;
+
+  napi_get_named_property(env, object, name, &value);
+  napi_typeof(env, value, &type);
+
+  if (type == napi_undefined)
+    return true;
+
+  if (type != napi_string)
+  {
+    napi_throw_type_error(env, nullptr, (std::string("Expected ") + name + " to be a string").c_str());
+    return false;
+  }
+
+  result = get_string(env, value);
+  return true;
+}
+
+// the compiler settings of an options object, Luau's defaults for anything else; false (with an exception pending)
+// for settings the compiler doesn't have
+static bool get_compile_options(napi_env env, napi_value value, sld::CompileOptions &options)
+{
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+
+  if (type != napi_object)
+    return true;
+
+  return get_level_property(env, value, "optimizationLevel", options.optimization_level) &&
+         get_level_property(env, value, "debugLevel", options.debug_level) &&
+         get_string_property(env, value, "vectorLib", options.vector_lib) &&
+         get_string_property(env, value, "vectorCtor", options.vector_ctor) &&
+         get_string_property(env, value, "vectorType", options.vector_type);
+}
+
+static bool get_shared_array_buffer_view(napi_env env, napi_value value, napi_value &view)
+{
+  napi_value global;
+  napi_value constructor;
+  bool is_shared = false;
+
+  napi_get_global(env, &global);
+  napi_get_named_property(env, global, "SharedArrayBuffer", &constructor);
+
+  if (napi_instanceof(env, value, constructor, &is_shared) != napi_ok || !is_shared)
+  {
+    return false;
+  }
+
+  // node-api has no accessor for shared buffers themselves, a view over one goes through the typed array path
+  napi_get_named_property(env, global, "Uint8Array", &constructor);
+
+  return napi_new_instance(env, constructor, 1, &value, &view) == napi_ok;
+}
+
+// the memory behind a Buffer, ArrayBuffer, SharedArrayBuffer, TypedArray or DataView, without copying it; throws a
+// TypeError and returns false for anything else
+static bool get_bytes(napi_env env, napi_value value, std::string_view &bytes)
+{
+  void *data = nullptr;
+  size_t length = 0;
+  bool matches = false;
+
+  if (napi_is_typedarray(env, value, &matches) == napi_ok && matches)
+  {
+    napi_typedarray_type type;
+    size_t element_count = 0;
+
+    // the data pointer is already adjusted by the view's byte offset
+    napi_get_typedarray_info(env, value, &type, &element_count, &data, nullptr, nullptr);
+
+    switch (type)
+    {
+    case napi_int16_array:
+    case napi_uint16_array:
+      length = element_count * 2;
+      break;
+    case napi_int32_array:
+    case napi_uint32_array:
+    case napi_float32_array:
+      length = element_count * 4;
+      break;
+    case napi_float64_array:
+    case napi_bigint64_array:
+    case napi_biguint64_array:
+      length = element_count * 8;
+      break;
+    default:
+      length = element_count;
+      break;
+    }
+  }
+  else if (napi_is_dataview(env, value, &matches) == napi_ok && matches)
+  {
+    napi_get_dataview_info(env, value, &length, &data, nullptr, nullptr);
+  }
+  else if (napi_is_arraybuffer(env, value, &matches) == napi_ok && matches)
+  {
+    napi_get_arraybuffer_info(env, value, &data, &length);
+  }
+  else
+  {
+    napi_value view;
+
+    if (!get_shared_array_buffer_view(env, value, view))
+    {
+      napi_throw_type_error(env, nullptr, "Expected a Buffer, ArrayBuffer, SharedArrayBuffer, TypedArray or DataView");
+      return false;
+    }
+
+    return get_bytes(env, view, bytes);
+  }
+
+  bytes = std::string_view(static_cast<const char *>(data), length);
+
+  return true;
+}
+
+static napi_value make_string(napi_env env, std::string_view value)
+{
+  napi_value result;
+  napi_create_string_utf8(env, value.data(), value.size(), &result);
+
+  return result;
+}
+
+// an Error describing why reading the bytecode failed, with the failure's `offset`, `section` and `reason` as
+// properties; scripts that don't compile carry the compiler's message instead
+static napi_value make_error(napi_env env, const sld::BytecodeError &error)
+{
+  std::string text;
+
+  if (!error.detail.empty())
+  {
+    text = error.detail;
+  }
+  else if (!error.reason.empty())
+  {
+    text.append(error.reason).append(" (").append(error.section).append(" at offset ").append(std::to_string(error.offset)).append(")");
+  }
+  else
+  {
+    text = "Disassembly did not complete";
+  }
+
+  napi_value code;
+  napi_value result;
+  napi_value offset;
+
+  napi_create_string_utf8(env, "ERR_INVALID_BYTECODE", NAPI_AUTO_LENGTH, &code);
+  napi_create_error(env, code, make_string(env, text), &result);
+
+  napi_create_double(env, double(error.offset), &offset);
+  napi_set_named_property(env, result, "offset", offset);
+  napi_set_named_property(env, result, "section", make_string(env, error.section));
+  napi_set_named_property(env, result, "reason", make_string(env, error.reason));
+
+  return result;
+}
+
+static void throw_error(napi_env env, const sld::BytecodeError &error)
+{
+  napi_throw(env, make_error(env, error));
+}
+
+// an Error for a file that couldn't be opened or mapped, with the `path` and the system's `errno`
+static napi_value make_file_error(napi_env env, const std::string &path, const std::error_code &error)
+{
+  napi_value result;
+  napi_value code;
+
+  napi_create_error(env, nullptr, make_string(env, error.message() + ", open '" + path + "'"), &result);
+  napi_create_int32(env, error.value(), &code);
+
+  napi_set_named_property(env, result, "errno", code);
+  napi_set_named_property(env, result, "path", make_string(env, path));
+
+  return result;
+}
 
 napi_value script_disassemble(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const auto disassembled = disassembler.disassemble(get_string(env, args.at(0)), get_options(env, args.at(1)));
+
+  if (!disassembled.has_value())
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  return make_string(env, disassembled.value());
+}
+
+napi_value bytecode_disassemble(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view bytecode;
+
+  if (!get_bytes(env, args.at(0), bytecode))
+  {
+    return nullptr;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const auto disassembly = disassembler.disassemble_bytecode(bytecode, get_options(env, args.at(1)));
+
+  if (!disassembly.has_value())
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  return make_string(env, disassembly.value());
+}
+
+// state for one disassembly running on the libuv thread pool, the input buffer is kept alive through `input`
+struct AsyncDisassembly
+{
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  napi_ref input = nullptr;
+
+  bool is_script = false;
+  std::string script;
+  std::string_view bytecode;
+  sld::DisassembleOptions options;
+
+  // mapped on the worker thread instead of `bytecode` when not empty
+  std::string path;
+  std::error_code file_error;
+
+  std::optional<std::string> result;
+  sld::BytecodeError error;
+};
+
+static void async_disassembly_execute(napi_env env, void *data)
+{
+  auto task = static_cast<AsyncDisassembly *>(data);
+  auto &disassembler = sld::Disassembler::for_thread();
+
+  sld::MappedFile file;
+
+  if (!task->path.empty())
+  {
+    if (!file.open(task->path, &task->file_error))
+    {
+      return;
+    }
+
+    task->bytecode = file.view();
+  }
+
+  // the context is reused by the next task on this thread, so the result is copied out before returning
+  const auto disassembly = task->is_script ? disassembler.disassemble(task->script, task->options) : disassembler.disassemble_bytecode(task->bytecode, task->options);
+
+  if (disassembly.has_value())
+  {
+    task->result.emplace(disassembly.value());
+  }
+  else
+  {
+    task->error = disassembler.last_error();
+  }
+}
+
+static void async_disassembly_complete(napi_env env, napi_status status, void *data)
+{
+  auto task = static_cast<AsyncDisassembly *>(data);
+
+  if (status == napi_ok && task->result.has_value())
+  {
+    napi_resolve_deferred(env, task->deferred, make_string(env, task->result.value()));
+  }
+  else if (task->file_error)
+  {
+    napi_reject_deferred(env, task->deferred, make_file_error(env, task->path, task->file_error));
+  }
+  else
+  {
+    napi_reject_deferred(env, task->deferred, make_error(env, task->error));
+  }
+
+  if (task->input != nullptr)
+  {
+    napi_delete_reference(env, task->input);
+  }
+
+  napi_delete_async_work(env, task->work);
+  delete task;
+}
+
+static napi_value queue_async_disassembly(napi_env env, AsyncDisassembly *task)
+{
+  napi_value promise;
+  napi_value resource_name;
+
+  napi_create_promise(env, &task->deferred, &promise);
+  napi_create_string_utf8(env, "simple_lua_disassembler", NAPI_AUTO_LENGTH, &resource_name);
+  napi_create_async_work(env, nullptr, resource_name, async_disassembly_execute, async_disassembly_complete, task, &task->work);
+  napi_queue_async_work(env, task->work);
+
+  return promise;
+}
+
+napi_value script_disassemble_async(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  auto task = new AsyncDisassembly{};
+  task->is_script = true;
+  task->script = get_string(env, args.at(0));
+  task->options = get_options(env, args.at(1));
+
+  return queue_async_disassembly(env, task);
+}
+
+napi_value bytecode_disassemble_async(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view bytecode;
+
+  if (!get_bytes(env, args.at(0), bytecode))
+  {
+    return nullptr;
+  }
+
+  auto task = new AsyncDisassembly{};
+
+  // parsed in place on the worker thread, the reference keeps the buffer from being collected meanwhile
+  task->bytecode = bytecode;
+
+  napi_create_reference(env, args.at(0), 1, &task->input);
+  task->options = get_options(env, args.at(1));
+
+  return queue_async_disassembly(env, task);
+}
+
+// the path as given, or nothing (with a TypeError thrown) if it isn't a non-empty string
+static std::optional<std::string> get_path(napi_env env, napi_value value)
+{
+  napi_valuetype type;
+  napi_typeof(env, value, &type);
+
+  std::string path = type == napi_string ? get_string(env, value) : std::string();
+
+  if (path.empty())
+  {
+    napi_throw_type_error(env, nullptr, "Expected a file path");
+    return {};
+  }
+
+  return path;
+}
+
+// the file is mapped and parsed in place, its contents never pass through the JS heap
+napi_value file_disassemble(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  const auto path = get_path(env, args.at(0));
+
+  if (!path.has_value())
+  {
+    return nullptr;
+  }
+
+  sld::MappedFile file;
+  std::error_code file_error;
+
+  if (!file.open(path.value(), &file_error))
+  {
+    napi_throw(env, make_file_error(env, path.value(), file_error));
+    return nullptr;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const auto disassembly = disassembler.disassemble_bytecode(file.view(), get_options(env, args.at(1)));
+
+  if (!disassembly.has_value())
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  return make_string(env, disassembly.value());
+}
+
+// opening and mapping the file happens on the worker thread as well
+napi_value file_disassemble_async(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  auto path = get_path(env, args.at(0));
+
+  if (!path.has_value())
+  {
+    return nullptr;
+  }
+
+  auto task = new AsyncDisassembly{};
+  task->path = std::move(path.value());
+  task->options = get_options(env, args.at(1));
+
+  return queue_async_disassembly(env, task);
+}
+
+// a batch of buffers, or of scripts to compile, fanned out over the shared pool; with `on_result` every result is handed
+// to JS as soon as it is ready, otherwise all of them resolve the promise in input order
+struct BatchDisassembly
+{
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  napi_threadsafe_function on_result = nullptr;
+
+  std::vector<napi_ref> inputs;
+  std::vector<std::string_view> buffers;
+  sld::DisassembleOptions options;
+
+  // compiled on the pool instead of `buffers` when not empty
+  std::vector<std::string> scripts;
+  sld::CompileOptions compile_options;
+
+  std::vector<std::optional<std::string>> results;
+  std::vector<sld::BytecodeError> errors;
+
+  // results whose onResult call couldn't be queued (the function is closing); they count as delivered once the work
+  // completed, so the batch still finishes
+  std::atomic<size_t> undeliverable{0};
+
+  // only touched on the JS thread
+  size_t delivered = 0;
+  bool executed = false;
+};
+
+static napi_value make_result(napi_env env, const BatchDisassembly *task, size_t index)
+{
+  if (task->results[index].has_value())
+  {
+    return make_string(env, task->results[index].value());
+  }
+
+  return make_error(env, task->errors[index]);
+}
+
+static void batch_disassembly_finish(napi_env env, BatchDisassembly *task)
+{
+  if (task->on_result == nullptr)
+  {
+    napi_value results;
+    napi_create_array_with_length(env, task->results.size(), &results);
+
+    for (size_t i = 0; i < task->results.size(); ++i)
+    {
+      napi_set_element(env, results, uint32_t(i), make_result(env, task, i));
+    }
+
+    napi_resolve_deferred(env, task->deferred, results);
+  }
+  else
+  {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, task->deferred, undefined);
+  }
+
+  for (auto input : task->inputs)
+  {
+    napi_delete_reference(env, input);
+  }
+
+  napi_delete_async_work(env, task->work);
+  delete task;
+}
+
+static void batch_disassembly_deliver(napi_env env, napi_value callback, void *context, void *data)
+{
+  auto task = static_cast<BatchDisassembly *>(context);
+  const size_t index = reinterpret_cast<size_t>(data);
+
+  if (env != nullptr)
+  {
+    napi_value undefined;
+    std::array<napi_value, 2> args{};
+
+    napi_get_undefined(env, &undefined);
+    args[0] = make_result(env, task, index);
+    napi_create_uint32(env, uint32_t(index), &args[1]);
+
+    napi_call_function(env, undefined, callback, args.size(), args.data(), nullptr);
+  }
+
+  // delivered results aren't needed anymore
+  task->results[index].reset();
+
+  if (++task->delivered == task->results.size() && task->executed)
+  {
+    // without an environment (it is being torn down) there is no promise left to settle
+    if (env != nullptr)
+      batch_disassembly_finish(env, task);
+    else
+      delete task;
+  }
+}
+
+static void batch_disassembly_execute(napi_env env, void *data)
+{
+  auto task = static_cast<BatchDisassembly *>(data);
+
+  sld::ThreadPool::shared().parallel_for(task->results.size(), [task](size_t index)
+                                         {
+    auto &disassembler = sld::Disassembler::for_thread();
+    const auto disassembly = task->scripts.empty() ? disassembler.disassemble_bytecode(task->buffers[index], task->options)
+                                                   : disassembler.disassemble(task->scripts[index], task->options, task->compile_options);
+
+    if (disassembly.has_value())
+    {
+      task->results[index].emplace(disassembly.value());
+    }
+    else
+    {
+      task->errors[index] = disassembler.last_error();
+    }
+
+    if (task->on_result != nullptr && napi_call_threadsafe_function(task->on_result, reinterpret_cast<void *>(index), napi_tsfn_blocking) != napi_ok)
+    {
+      task->undeliverable++;
+    } });
+}
+
+static void batch_disassembly_complete(napi_env env, napi_status status, void *data)
+{
+  auto task = static_cast<BatchDisassembly *>(data);
+  task->executed = true;
+
+  if (task->on_result == nullptr)
+  {
+    batch_disassembly_finish(env, task);
+    return;
+  }
+
+  // queued calls are still delivered after the release; the last one settles the promise
+  napi_release_threadsafe_function(task->on_result, napi_tsfn_release);
+  task->delivered += task->undeliverable;
+
+  if (task->delivered == task->results.size())
+  {
+    batch_disassembly_finish(env, task);
+  }
+}
+
+static bool is_array(napi_env env, napi_value value)
+{
+  bool result = false;
+  return napi_is_array(env, value, &result) == napi_ok && result;
+}
+
+// starts a batch whose inputs are set up; `options` may carry an onResult callback
+static napi_value queue_batch_disassembly(napi_env env, BatchDisassembly *task, napi_value options)
+{
+  napi_valuetype options_type;
+  napi_typeof(env, options, &options_type);
+
+  if (options_type == napi_object)
+  {
+    napi_value on_result;
+    napi_valuetype on_result_type;
+
+    napi_get_named_property(env, options, "onResult", &on_result);
+    napi_typeof(env, on_result, &on_result_type);
+
+    if (on_result_type == napi_function)
+    {
+      napi_value resource_name;
+      napi_create_string_utf8(env, "simple_lua_disassembler", NAPI_AUTO_LENGTH, &resource_name);
+      napi_create_threadsafe_function(env, on_result, nullptr, resource_name, 0, 1, nullptr, nullptr, task, batch_disassembly_deliver, &task->on_result);
+    }
+  }
+
+  napi_value promise;
+  napi_value resource_name;
+
+  napi_create_promise(env, &task->deferred, &promise);
+  napi_create_string_utf8(env, "simple_lua_disassembler", NAPI_AUTO_LENGTH, &resource_name);
+  napi_create_async_work(env, nullptr, resource_name, batch_disassembly_execute, batch_disassembly_complete, task, &task->work);
+  napi_queue_async_work(env, task->work);
+
+  return promise;
+}
+
+napi_value bytecode_disassemble_many(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  if (!is_array(env, args.at(0)))
+  {
+    napi_throw_type_error(env, nullptr, "Expected an array of buffers");
+    return nullptr;
+  }
+
+  auto task = new BatchDisassembly{};
+
+  uint32_t count = 0;
+  napi_get_array_length(env, args.at(0), &count);
+
+  task->inputs.resize(count);
+  task->buffers.resize(count);
+  task->results.resize(count);
+  task->errors.resize(count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    napi_value buffer;
+
+    napi_get_element(env, args.at(0), i, &buffer);
+
+    if (!get_bytes(env, buffer, task->buffers[i]))
+    {
+      for (uint32_t j = 0; j < i; ++j)
+      {
+        napi_delete_reference(env, task->inputs[j]);
+      }
+
+      delete task;
+      return nullptr;
+    }
+
+    napi_create_reference(env, buffer, 1, &task->inputs[i]);
+  }
+
+  task->options = get_options(env, args.at(1));
+
+  return queue_batch_disassembly(env, task, args.at(1));
+}
+
+napi_value script_disassemble_many(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  sld::CompileOptions compile_options;
+
+  if (!get_compile_options(env, args.at(1), compile_options))
+  {
+    return nullptr;
+  }
+
+  if (!is_array(env, args.at(0)))
+  {
+    napi_throw_type_error(env, nullptr, "Expected an array of strings");
+    return nullptr;
+  }
+
+  uint32_t count = 0;
+  napi_get_array_length(env, args.at(0), &count);
+
+  std::vector<std::string> scripts(count);
+
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    napi_value script;
+    napi_valuetype type;
+
+    napi_get_element(env, args.at(0), i, &script);
+    napi_typeof(env, script, &type);
+
+    if (type != napi_string)
+    {
+      napi_throw_type_error(env, nullptr, "Expected an array of strings");
+      return nullptr;
+    }
+
+    scripts[i] = get_string(env, script);
+  }
+
+  auto task = new BatchDisassembly{};
+
+  task->scripts = std::move(scripts);
+  task->compile_options = std::move(compile_options);
+  task->results.resize(count);
+  task->errors.resize(count);
+  task->options = get_options(env, args.at(1));
+
+  return queue_batch_disassembly(env, task, args.at(1));
+}
+
+// shared by the formatting thread, which waits while the stream is paused, and the JS thread, which pauses it when
+// the stream's buffer is full and resumes or cancels it from the stream; JS holds it through the handle returned by
+// disassembleBytecodeChunks, so calls on a stream that already ended are harmless
+struct StreamControl
+{
+  std::mutex mutex;
+  std::condition_variable changed;
+
+  bool paused = false;
+  bool cancelled = false;
+
+  void set(bool StreamControl::*flag, bool value)
+  {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      this->*flag = value;
+    }
+
+    changed.notify_all();
+  }
+};
+
+// hands every chunk of the listing to JS as a Buffer that takes ownership of the chunk. Chunks wait while the
+// stream is paused, and the threadsafe function's queue is bounded, so a consumer that falls behind blocks the
+// formatting thread instead of piling up chunks
+class ChunkSink : public sld::Sink
+{
+public:
+  ChunkSink(napi_threadsafe_function on_chunk, StreamControl &control)
+      : on_chunk(on_chunk), control(control)
+  {
+  }
+
+  void write(std::string_view chunk) override
+  {
+    {
+      std::unique_lock<std::mutex> lock(control.mutex);
+      control.changed.wait(lock, [this]()
+                           { return !control.paused || control.cancelled; });
+
+      if (control.cancelled)
+        return;
+    }
+
+    auto copy = new std::string(chunk);
+
+    if (napi_call_threadsafe_function(on_chunk, copy, napi_tsfn_blocking) == napi_ok)
+    {
+      queued++;
+      return;
+    }
+
+    // the function is closing with the environment, nothing written from here on would be delivered
+    delete copy;
+    control.set(&StreamControl::cancelled, true);
+  }
+
+  bool cancelled() const override
+  {
+    std::lock_guard<std::mutex> lock(control.mutex);
+    return control.cancelled;
+  }
+
+  size_t queued = 0;
+
+private:
+  napi_threadsafe_function on_chunk;
+  StreamControl &control;
+};
+
+// chunks queued ahead of the JS thread before the formatting thread waits
+static constexpr size_t max_queued_chunks = 4;
+
+struct StreamDisassembly
+{
+  napi_async_work work = nullptr;
+  napi_deferred deferred = nullptr;
+  napi_threadsafe_function on_chunk = nullptr;
+  napi_ref input = nullptr;
+
+  std::string_view bytecode;
+  sld::DisassembleOptions options;
+  std::shared_ptr<StreamControl> control;
+
+  bool succeeded = false;
+  sld::BytecodeError error;
+
+  // set by the worker, only read on the JS thread once `executed` is
+  size_t queued = 0;
+
+  // only touched on the JS thread
+  size_t delivered = 0;
+  bool executed = false;
+};
+
+static void stream_disassembly_finish(napi_env env, StreamDisassembly *task)
+{
+  if (task->succeeded)
+  {
+    napi_value undefined;
+    napi_get_undefined(env, &undefined);
+    napi_resolve_deferred(env, task->deferred, undefined);
+  }
+  else
+  {
+    napi_reject_deferred(env, task->deferred, make_error(env, task->error));
+  }
+
+  napi_delete_reference(env, task->input);
+  napi_delete_async_work(env, task->work);
+  delete task;
+}
+
+static void stream_disassembly_deliver(napi_env env, napi_value callback, void *context, void *data)
+{
+  auto task = static_cast<StreamDisassembly *>(context);
+  auto chunk = static_cast<std::string *>(data);
+
+  if (env != nullptr)
+  {
+    napi_value undefined;
+    napi_value buffer;
+    napi_value accepted;
+    bool more = true;
+
+    napi_get_undefined(env, &undefined);
+    napi_create_external_buffer(
+        env, chunk->size(), chunk->data(), [](napi_env, void *, void *hint)
+        { delete static_cast<std::string *>(hint); },
+        chunk, &buffer);
+
+    // the callback returns what Readable.push() did, false once the stream's buffer is full
+    if (napi_call_function(env, undefined, callback, 1, &buffer, &accepted) == napi_ok && napi_get_value_bool(env, accepted, &more) == napi_ok && !more)
+    {
+      task->control->set(&StreamControl::paused, true);
+    }
+  }
+  else
+  {
+    delete chunk;
+  }
+
+  ++task->delivered;
+
+  if (task->executed && task->delivered == task->queued)
+  {
+    // without an environment (it is being torn down) there is no promise left to settle
+    if (env != nullptr)
+      stream_disassembly_finish(env, task);
+    else
+      delete task;
+  }
+}
+
+static void stream_disassembly_execute(napi_env env, void *data)
+{
+  auto task = static_cast<StreamDisassembly *>(data);
+
+  ChunkSink sink(task->on_chunk, *task->control);
+  auto &disassembler = sld::Disassembler::for_thread();
+
+  task->succeeded = disassembler.disassemble_bytecode_to(sink, task->bytecode, task->options);
+  task->queued = sink.queued;
+
+  if (!task->succeeded)
+  {
+    task->error = disassembler.last_error();
+  }
+}
+
+static void stream_disassembly_complete(napi_env env, napi_status status, void *data)
+{
+  auto task = static_cast<StreamDisassembly *>(data);
+  task->executed = true;
+  task->succeeded = task->succeeded && status == napi_ok;
+
+  // queued chunks are still delivered after the release; the last one settles the promise
+  napi_release_threadsafe_function(task->on_chunk, napi_tsfn_release);
+
+  if (task->delivered == task->queued)
+  {
+    stream_disassembly_finish(env, task);
+  }
+}
+
+// resolves `done` once the listing was handed over (or the stream was cancelled); `control` goes to
+// resumeChunks/cancelChunks
+napi_value bytecode_disassemble_chunks(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 3;
+  std::array<napi_value, 3> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view bytecode;
+
+  if (!get_bytes(env, args.at(0), bytecode))
+  {
+    return nullptr;
+  }
+
+  auto task = new StreamDisassembly{};
+  task->bytecode = bytecode;
+  task->control = std::make_shared<StreamControl>();
+
+  napi_create_reference(env, args.at(0), 1, &task->input);
+  task->options = get_options(env, args.at(1));
+
+  napi_value promise;
+  napi_value control;
+  napi_value result;
+  napi_value resource_name;
+
+  napi_create_promise(env, &task->deferred, &promise);
+  napi_create_external(
+      env, new std::shared_ptr<StreamControl>(task->control), [](napi_env, void *data, void *)
+      { delete static_cast<std::shared_ptr<StreamControl> *>(data); },
+      nullptr, &control);
+
+  napi_create_object(env, &result);
+  napi_set_named_property(env, result, "done", promise);
+  napi_set_named_property(env, result, "control", control);
+
+  napi_create_string_utf8(env, "simple_lua_disassembler", NAPI_AUTO_LENGTH, &resource_name);
+  napi_create_threadsafe_function(env, args.at(2), nullptr, resource_name, max_queued_chunks, 1, nullptr, nullptr, task, stream_disassembly_deliver, &task->on_chunk);
+  napi_create_async_work(env, nullptr, resource_name, stream_disassembly_execute, stream_disassembly_complete, task, &task->work);
+  napi_queue_async_work(env, task->work);
+
+  return result;
+}
+
+static StreamControl *get_stream_control(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  napi_value control;
+  void *data = nullptr;
+
+  napi_get_cb_info(env, info, &arg_count, &control, nullptr, nullptr);
+
+  if (arg_count < 1 || napi_get_value_external(env, control, &data) != napi_ok)
+  {
+    napi_throw_type_error(env, nullptr, "Expected a stream handle");
+    return nullptr;
+  }
+
+  return static_cast<std::shared_ptr<StreamControl> *>(data)->get();
+}
+
+napi_value chunks_resume(napi_env env, napi_callback_info info)
+{
+  if (StreamControl *control = get_stream_control(env, info))
+    control->set(&StreamControl::paused, false);
+
+  return nullptr;
+}
+
+// the formatting thread stops at the next function and the remaining chunks are dropped
+napi_value chunks_cancel(napi_env env, napi_callback_info info)
+{
+  if (StreamControl *control = get_stream_control(env, info))
+    control->set(&StreamControl::cancelled, true);
+
+  return nullptr;
+}
+
+template <typename T>
+static napi_value make_typed_array(napi_env env, napi_typedarray_type type, const std::vector<T> &values)
+{
+  void *data = nullptr;
+  napi_value buffer;
+  napi_value result;
+
+  napi_create_arraybuffer(env, values.size() * sizeof(T), &data, &buffer);
+
+  if (!values.empty())
+  {
+    memcpy(data, values.data(), values.size() * sizeof(T));
+  }
+
+  napi_create_typedarray(env, type, values.size(), buffer, 0, &result);
+
+  return result;
+}
+
+static void set_uint32_property(napi_env env, napi_value object, const char *name, uint32_t value)
+{
+  napi_value property;
+  napi_create_uint32(env, value, &property);
+  napi_set_named_property(env, object, name, property);
+}
+
+static napi_value make_constant_value(napi_env env, const sld::Bytecode &bytecode, const sld::Function &function, const sld::Constant &constant)
+{
+  napi_value value;
+
+  switch (constant.type)
+  {
+  case sld::Constant::Type_Boolean:
+    napi_get_boolean(env, constant.valueBoolean, &value);
+    break;
+
+  case sld::Constant::Type_Number:
+    napi_create_double(env, constant.valueNumber, &value);
+    break;
+
+  case sld::Constant::Type_Vector:
+    napi_create_array_with_length(env, 4, &value);
+
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+      napi_value component;
+      napi_create_double(env, constant.valueVector[i], &component);
+      napi_set_element(env, value, i, component);
+    }
+    break;
+
+  case sld::Constant::Type_String:
+    // index into the string table, which is 1-based in the bytecode
+    napi_create_int32(env, int32_t(constant.valueString) - 1, &value);
+    break;
+
+  case sld::Constant::Type_Import:
+  {
+    const sld::Constant *constants = bytecode.constants_of(function);
+    const uint32_t count = constant.valueImport >> 30;
+
+    napi_create_array_with_length(env, count, &value);
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+      const uint32_t id = (constant.valueImport >> (20 - i * 10)) & 1023;
+      const std::string_view name = id < function.sizek ? bytecode.string(constants[id].valueString) : std::string_view{};
+
+      napi_set_element(env, value, i, make_string(env, name));
+    }
+    break;
+  }
+
+  case sld::Constant::Type_Closure:
+    napi_create_uint32(env, constant.valueClosure, &value);
+    break;
+
+  default:
+    napi_get_null(env, &value);
+    break;
+  }
+
+  return value;
+}
+
+// the parsed bytecode as flat columns: one typed array per instruction field and per proto field covering every proto,
+// with `instructionStarts`/`constantStarts` delimiting each proto's range. index.cjs slices these into per-proto
+// objects, which is far cheaper than creating thousands of small objects and typed arrays through node-api
+napi_value bytecode_decode(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view data;
+
+  if (!get_bytes(env, args.at(0), data))
+  {
+    return nullptr;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const sld::Bytecode *bytecode = disassembler.read(data, get_options(env, args.at(1)));
+
+  if (bytecode == nullptr)
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  const size_t function_count = bytecode->functions.size();
+
+  // the columns are copied into typed arrays, keeping them around would only pin the largest blob ever decoded
+  sld::DecodedFunction decoded;
+  std::vector<uint32_t> instruction_starts;
+  std::vector<uint32_t> constant_starts;
+  std::vector<uint32_t> proto_fields;
+  std::vector<uint8_t> constant_types;
+
+  for (const auto &function : bytecode->functions)
+  {
+    instruction_starts.push_back(uint32_t(decoded.size()));
+    constant_starts.push_back(function.constants_start);
+    proto_fields.insert(proto_fields.end(), {function.linedefined, function.maxstacksize, function.numparams, function.nups, function.is_vararg, function.flags});
+
+    sld::decode_function(*bytecode, function, decoded);
+  }
+
+  instruction_starts.push_back(uint32_t(decoded.size()));
+  constant_starts.push_back(uint32_t(bytecode->constants.size()));
+
+  napi_value strings;
+  napi_value names;
+  napi_value constant_values;
+
+  napi_create_array_with_length(env, bytecode->strings.size(), &strings);
+
+  for (size_t i = 0; i < bytecode->strings.size(); ++i)
+  {
+    napi_set_element(env, strings, uint32_t(i), make_string(env, bytecode->strings[i]));
+  }
+
+  napi_create_array_with_length(env, function_count, &names);
+  napi_create_array_with_length(env, bytecode->constants.size(), &constant_values);
+
+  for (size_t i = 0; i < function_count; ++i)
+  {
+    const auto &function = bytecode->functions[i];
+    const sld::Constant *constants = bytecode->constants_of(function);
+
+    napi_set_element(env, names, uint32_t(i), make_string(env, function.debugname));
+
+    for (uint32_t k = 0; k < function.sizek; ++k)
+    {
+      constant_types.push_back(uint8_t(constants[k].type));
+      napi_set_element(env, constant_values, function.constants_start + k, make_constant_value(env, *bytecode, function, constants[k]));
+    }
+  }
+
+  napi_value result;
+  napi_create_object(env, &result);
+
+  set_uint32_property(env, result, "version", bytecode->version);
+  set_uint32_property(env, result, "typesVersion", bytecode->typesversion);
+  set_uint32_property(env, result, "mainId", bytecode->mainid);
+  napi_set_named_property(env, result, "encoding", make_string(env, sld::encoding_name(bytecode->encoding)));
+  napi_set_named_property(env, result, "strings", strings);
+
+  napi_set_named_property(env, result, "names", names);
+  napi_set_named_property(env, result, "protoFields", make_typed_array(env, napi_uint32_array, proto_fields));
+  napi_set_named_property(env, result, "instructionStarts", make_typed_array(env, napi_uint32_array, instruction_starts));
+  napi_set_named_property(env, result, "constantStarts", make_typed_array(env, napi_uint32_array, constant_starts));
+
+  napi_set_named_property(env, result, "pc", make_typed_array(env, napi_uint32_array, decoded.pc));
+  napi_set_named_property(env, result, "opcode", make_typed_array(env, napi_uint8_array, decoded.opcode));
+  napi_set_named_property(env, result, "a", make_typed_array(env, napi_uint8_array, decoded.a));
+  napi_set_named_property(env, result, "b", make_typed_array(env, napi_uint8_array, decoded.b));
+  napi_set_named_property(env, result, "c", make_typed_array(env, napi_uint8_array, decoded.c));
+  napi_set_named_property(env, result, "d", make_typed_array(env, napi_int16_array, decoded.d));
+  napi_set_named_property(env, result, "aux", make_typed_array(env, napi_uint32_array, decoded.aux));
+  napi_set_named_property(env, result, "target", make_typed_array(env, napi_int32_array, decoded.target));
+
+  napi_set_named_property(env, result, "constantTypes", make_typed_array(env, napi_uint8_array, constant_types));
+  napi_set_named_property(env, result, "constantValues", constant_values);
+
+  return result;
+}
+
+// where every proto starts and what it can be told by, as flat columns like decodeBytecodeColumns; `protoFields` holds
+// linedefined, sizecode and sizek of each proto in turn
+napi_value bytecode_inspect(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  std::array<napi_value, 1> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view data;
+
+  if (!get_bytes(env, args.at(0), data))
+  {
+    return nullptr;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const sld::BytecodeIndex *index = disassembler.inspect(data);
+
+  if (index == nullptr)
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  // copied into typed arrays below, so nothing is kept once they are
+  std::vector<double> offsets;
+  std::vector<uint32_t> proto_fields;
+
+  napi_value names;
+  napi_create_array_with_length(env, index->protos.size(), &names);
+
+  for (size_t i = 0; i < index->protos.size(); ++i)
+  {
+    const auto &proto = index->protos[i];
+
+    offsets.push_back(double(proto.offset));
+    proto_fields.insert(proto_fields.end(), {proto.linedefined, proto.sizecode, proto.sizek});
+
+    napi_set_element(env, names, uint32_t(i), make_string(env, proto.debugname));
+  }
+
+  napi_value result;
+  napi_create_object(env, &result);
+
+  set_uint32_property(env, result, "version", index->version);
+  set_uint32_property(env, result, "typesVersion", index->typesversion);
+  set_uint32_property(env, result, "mainId", index->mainid);
+
+  napi_set_named_property(env, result, "names", names);
+  napi_set_named_property(env, result, "offsets", make_typed_array(env, napi_float64_array, offsets));
+  napi_set_named_property(env, result, "protoFields", make_typed_array(env, napi_uint32_array, proto_fields));
+
+  return result;
+}
+
+napi_value function_disassemble(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 3;
+  std::array<napi_value, 3> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view bytecode;
+
+  if (!get_bytes(env, args.at(0), bytecode))
+  {
+    return nullptr;
+  }
+
+  napi_valuetype type;
+  napi_typeof(env, args.at(1), &type);
+
+  const auto options = get_options(env, args.at(2));
+  auto &disassembler = sld::Disassembler::for_thread();
+  std::optional<std::string_view> disassembly;
+
+  if (type == napi_string)
+  {
+    disassembly = disassembler.disassemble_function(bytecode, get_string(env, args.at(1)), options);
+  }
+  else
+  {
+    double id = -1;
+
+    if (type == napi_number)
+      napi_get_value_double(env, args.at(1), &id);
+
+    if (!(id >= 0 && id <= double(UINT32_MAX) && id == double(uint32_t(id))))
+    {
+      napi_throw_type_error(env, nullptr, "Expected a function index or name");
+      return nullptr;
+    }
+
+    disassembly = disassembler.disassemble_function(bytecode, uint32_t(id), options);
+  }
+
+  if (!disassembly.has_value())
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  return make_string(env, disassembly.value());
+}
+
+// basic blocks of every proto as flat columns, see sld::ControlFlowGraph; index.cjs slices them per proto.
+// `blockRanges`/`edgeRanges` delimit each proto's blocks and edges, its offset arrays have one extra entry each
+napi_value bytecode_control_flow(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view data;
+
+  if (!get_bytes(env, args.at(0), data))
+  {
+    return nullptr;
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const sld::Bytecode *bytecode = disassembler.read(data, get_options(env, args.at(1)));
+
+  if (bytecode == nullptr)
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  // only the per-function scratch is kept, the columns are copied into typed arrays and dropped
+  auto &scratch = disassembler.control_flow_scratch();
+  sld::ControlFlowGraph &graph = scratch.graph;
+
+  sld::ControlFlowGraph columns;
+  std::vector<uint32_t> block_ranges;
+  std::vector<uint32_t> edge_ranges;
+
+  for (const auto &function : bytecode->functions)
+  {
+    block_ranges.push_back(uint32_t(columns.block_start.size()));
+    edge_ranges.push_back(uint32_t(columns.successors.size()));
+
+    sld::build_control_flow(*bytecode, function, scratch, graph);
+
+    auto append = [](std::vector<uint32_t> &to, const std::vector<uint32_t> &from)
+    { to.insert(to.end(), from.begin(), from.end()); };
+
+    append(columns.block_start, graph.block_start);
+    append(columns.block_end, graph.block_end);
+    append(columns.successor_offsets, graph.successor_offsets);
+    append(columns.successors, graph.successors);
+    append(columns.predecessor_offsets, graph.predecessor_offsets);
+    append(columns.predecessors, graph.predecessors);
+  }
+
+  block_ranges.push_back(uint32_t(columns.block_start.size()));
+  edge_ranges.push_back(uint32_t(columns.successors.size()));
+
+  napi_value result;
+  napi_create_object(env, &result);
+
+  napi_set_named_property(env, result, "blockRanges", make_typed_array(env, napi_uint32_array, block_ranges));
+  napi_set_named_property(env, result, "edgeRanges", make_typed_array(env, napi_uint32_array, edge_ranges));
+  napi_set_named_property(env, result, "blockStart", make_typed_array(env, napi_uint32_array, columns.block_start));
+  napi_set_named_property(env, result, "blockEnd", make_typed_array(env, napi_uint32_array, columns.block_end));
+  napi_set_named_property(env, result, "successorOffsets", make_typed_array(env, napi_uint32_array, columns.successor_offsets));
+  napi_set_named_property(env, result, "successors", make_typed_array(env, napi_uint32_array, columns.successors));
+  napi_set_named_property(env, result, "predecessorOffsets", make_typed_array(env, napi_uint32_array, columns.predecessor_offsets));
+  napi_set_named_property(env, result, "predecessors", make_typed_array(env, napi_uint32_array, columns.predecessors));
+
+  return result;
+}
+
+napi_value bytecode_export_control_flow(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  std::string_view data;
+
+  if (!get_bytes(env, args.at(0), data))
+  {
+    return nullptr;
+  }
+
+  bool json = false;
+  napi_valuetype options_type;
+  napi_typeof(env, args.at(1), &options_type);
+
+  if (options_type == napi_object)
+  {
+    napi_value format;
+    napi_valuetype format_type;
+
+    napi_get_named_property(env, args.at(1), "format", &format);
+    napi_typeof(env, format, &format_type);
+
+    json = format_type == napi_string && get_string(env, format) == "json";
+  }
+
+  auto &disassembler = sld::Disassembler::for_thread();
+  const sld::Bytecode *bytecode = disassembler.read(data, get_options(env, args.at(1)));
+
+  if (bytecode == nullptr)
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
+
+  std::string exported;
+
+  {
+    sld::Writer writer(exported);
+
+    if (json)
+      sld::write_control_flow_json(*bytecode, writer, disassembler.control_flow_scratch());
+    else
+      sld::write_control_flow_dot(*bytecode, writer, disassembler.control_flow_scratch());
+  }
+
+  return make_string(env, exported);
+}
+
+// registerEncoding(name, key): `key` is either the multiplier that decodes an opcode or a 256 byte table mapping every
+// encoded opcode to the real one; the table is copied, so decoding never calls back into JS
+napi_value encoding_register(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  napi_valuetype name_type;
+  napi_valuetype key_type;
+  napi_typeof(env, args.at(0), &name_type);
+  napi_typeof(env, args.at(1), &key_type);
+
+  if (name_type != napi_string)
+  {
+    napi_throw_type_error(env, nullptr, "Expected the encoding name to be a string");
+    return nullptr;
+  }
+
+  std::optional<sld::BytecodeEncoding> registered;
+
+  if (key_type == napi_number)
+  {
+    uint32_t multiplier = 0;
+    napi_get_value_uint32(env, args.at(1), &multiplier);
+
+    if (multiplier > 255 || multiplier % 2 == 0)
+    {
+      napi_throw_range_error(env, nullptr, "Expected an odd multiplier between 1 and 255");
+      return nullptr;
+    }
+
+    registered = sld::register_encoding(get_string(env, args.at(0)), uint8_t(multiplier));
+  }
+  else
+  {
+    std::string_view bytes;
+
+    if (!get_bytes(env, args.at(1), bytes))
+    {
+      return nullptr;
+    }
+
+    if (bytes.size() != 256)
+    {
+      napi_throw_range_error(env, nullptr, "Expected an opcode table of 256 bytes");
+      return nullptr;
+    }
+
+    std::array<uint8_t, 256> table;
+    memcpy(table.data(), bytes.data(), table.size());
+
+    registered = sld::register_encoding(get_string(env, args.at(0)), table);
+  }
+
+  if (!registered.has_value())
+  {
+    napi_throw_error(env, nullptr, "Encoding name is reserved or already registered with a different key");
+    return nullptr;
+  }
+
+  return nullptr;
+}
+
+// name of the registered encoding the bytecode most likely uses
+napi_value encoding_detect(napi_env env, napi_callback_info info)
 {
   size_t arg_count = 1;
   std::array<napi_value, 1> args{};
 
   napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
 
-  size_t script_length = 0;
-  napi_get_value_string_utf8(env, args.at(0), nullptr, 0, &script_length);
-  std::string script(script_length, '\0');
-  script.reserve(script_length);
+  std::string_view data;
+
+  if (!get_bytes(env, args.at(0), data))
+  {
+    return nullptr;
+  }
 
-  napi_get_value_string_utf8(env, args.at(0), &script[0], script.length() + 1, nullptr);
+  auto &disassembler = sld::Disassembler::for_thread();
+  const sld::Bytecode *bytecode = disassembler.read(data, sld::DisassembleOptions(sld::BytecodeEncoding::Auto));
 
-  const auto disassembled = sld::disassemble(script);
+  if (bytecode == nullptr)
+  {
+    throw_error(env, disassembler.last_error());
+    return nullptr;
+  }
 
-  if (!disassembled.has_value())
+  return make_string(env, sld::encoding_name(bytecode->encoding));
+}
+
+// a byte budget property of the cache options; absent ones leave their cache as it is
+static bool get_budget_property(napi_env env, napi_value object, const char *name, std::optional<size_t> &budget)
+{
+  napi_value value;
+  napi_valuetype type;
+  double bytes = 0;
+
+  napi_get_named_property(env, object, name, &value);
+  napi_typeof(env, value, &type);
+
+  if (type == napi_undefined)
+    return true;
+
+  if (type != napi_number || napi_get_value_double(env, value, &bytes) != napi_ok || !(bytes >= 0))
+  {
+    napi_throw_range_error(env, nullptr, (std::string("Expected ") + name + " to be a number of bytes").c_str());
+    return false;
+  }
+
+  budget = size_t(bytes);
+  return true;
+}
+
+// configureCache({ maxBytes, compiledMaxBytes }): listings of repeated inputs are kept up to `maxBytes`, the bytecode
+// of compiled scripts up to `compiledMaxBytes`; 0 turns a cache off and at least one of them has to be given
+napi_value cache_configure(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  std::array<napi_value, 1> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  napi_valuetype type;
+  napi_typeof(env, args.at(0), &type);
+
+  if (type != napi_object)
+  {
+    napi_throw_type_error(env, nullptr, "Expected an options object");
+    return nullptr;
+  }
+
+  std::optional<size_t> budget;
+  std::optional<size_t> compiled_budget;
+
+  if (!get_budget_property(env, args.at(0), "maxBytes", budget) || !get_budget_property(env, args.at(0), "compiledMaxBytes", compiled_budget))
+  {
+    return nullptr;
+  }
+
+  if (!budget.has_value() && !compiled_budget.has_value())
   {
-    napi_throw_error(env, nullptr, "Invalid bytecode version detected");
+    napi_throw_range_error(env, nullptr, "Expected maxBytes or compiledMaxBytes to be a number of bytes");
+    return nullptr;
   }
 
-  const auto disassembly = disassembled.value();
+  if (budget.has_value())
+    sld::ResultCache::shared().set_budget(budget.value());
+
+  if (compiled_budget.has_value())
+    sld::ResultCache::compiled().set_budget(compiled_budget.value());
+
+  return nullptr;
+}
+
+static void set_number_property(napi_env env, napi_value object, const char *name, double value)
+{
+  napi_value number;
+  napi_create_double(env, value, &number);
+  napi_set_named_property(env, object, name, number);
+}
+
+static napi_value make_cache_stats(napi_env env, sld::ResultCache &cache)
+{
+  const sld::CacheStats stats = cache.stats();
 
   napi_value result;
-  napi_create_string_utf8(env, disassembly.data(), disassembly.size(), &result);
+  napi_create_object(env, &result);
+
+  set_number_property(env, result, "hits", double(stats.hits));
+  set_number_property(env, result, "misses", double(stats.misses));
+  set_number_property(env, result, "evictions", double(stats.evictions));
+  set_number_property(env, result, "entries", double(stats.entries));
+  set_number_property(env, result, "bytes", double(stats.bytes));
+  set_number_property(env, result, "maxBytes", double(stats.budget));
 
   return result;
 }
 
-napi_value bytecode_disassemble(napi_env env, napi_callback_info info)
+// the listing cache's numbers, with those of the compiled scripts under `compiled`
+napi_value cache_stats(napi_env env, napi_callback_info info)
+{
+  napi_value result = make_cache_stats(env, sld::ResultCache::shared());
+  napi_set_named_property(env, result, "compiled", make_cache_stats(env, sld::ResultCache::compiled()));
+
+  return result;
+}
+
+napi_value cache_clear(napi_env env, napi_callback_info info)
+{
+  sld::ResultCache::shared().clear();
+  sld::ResultCache::compiled().clear();
+
+  return nullptr;
+}
+
+napi_value cache_save(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  std::array<napi_value, 1> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  const auto path = get_path(env, args.at(0));
+
+  if (!path.has_value())
+  {
+    return nullptr;
+  }
+
+  if (!sld::ResultCache::shared().save(path.value()))
+  {
+    napi_throw_error(env, nullptr, ("Could not write the cache to '" + path.value() + "'").c_str());
+  }
+
+  return nullptr;
+}
+
+// the number of entries added; a missing or unreadable file adds none, so warm starts need no existence check
+napi_value cache_load(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  std::array<napi_value, 1> args{};
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+
+  const auto path = get_path(env, args.at(0));
+
+  if (!path.has_value())
+  {
+    return nullptr;
+  }
+
+  const int64_t loaded = sld::ResultCache::shared().load(path.value());
+
+  napi_value result;
+  napi_create_double(env, double(loaded < 0 ? 0 : loaded), &result);
+
+  return result;
+}
+
+static sld::Disassembler *unwrap_disassembler(napi_env env, napi_callback_info info, size_t &arg_count, napi_value *args)
+{
+  napi_value self;
+  napi_get_cb_info(env, info, &arg_count, args, &self, nullptr);
+
+  sld::Disassembler *disassembler = nullptr;
+  napi_unwrap(env, self, reinterpret_cast<void **>(&disassembler));
+
+  return disassembler;
+}
+
+napi_value disassembler_constructor(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 1;
+  std::array<napi_value, 1> args{};
+  napi_value self;
+
+  napi_get_cb_info(env, info, &arg_count, args.data(), &self, nullptr);
+
+  size_t retained_bytes = sld::Disassembler::default_retained_bytes;
+
+  napi_valuetype options_type;
+  napi_typeof(env, args.at(0), &options_type);
+
+  if (options_type == napi_object)
+  {
+    bool has_retained_bytes = false;
+    napi_has_named_property(env, args.at(0), "retainedBytes", &has_retained_bytes);
+
+    if (has_retained_bytes)
+    {
+      napi_value value;
+      int64_t retained = 0;
+
+      napi_get_named_property(env, args.at(0), "retainedBytes", &value);
+      napi_get_value_int64(env, value, &retained);
+
+      retained_bytes = retained > 0 ? size_t(retained) : 0;
+    }
+  }
+
+  auto disassembler = new sld::Disassembler(retained_bytes);
+
+  napi_wrap(
+      env, self, disassembler, [](napi_env, void *data, void *)
+      { delete static_cast<sld::Disassembler *>(data); },
+      nullptr, nullptr);
+
+  return self;
+}
+
+napi_value disassembler_disassemble(napi_env env, napi_callback_info info)
 {
   size_t arg_count = 2;
   std::array<napi_value, 2> args{};
 
-  napi_get_cb_info(env, info, &arg_count, args.data(), nullptr, nullptr);
+  auto disassembler = unwrap_disassembler(env, info, arg_count, args.data());
 
-  uint8_t *raw_buffer;
+  const auto disassembly = disassembler->disassemble(get_string(env, args.at(0)), get_options(env, args.at(1)));
+
+  if (!disassembly.has_value())
+  {
+    throw_error(env, disassembler->last_error());
+    return nullptr;
+  }
 
-  size_t bytecode_length = 0;
-  size_t encoding_length = 0;
+  return make_string(env, disassembly.value());
+}
 
-  napi_get_buffer_info(env, args.at(0), reinterpret_cast<void **>(&raw_buffer), &bytecode_length);
-  napi_get_value_string_utf8(env, args.at(1), nullptr, 0, &encoding_length);
+napi_value disassembler_disassemble_bytecode(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 2;
+  std::array<napi_value, 2> args{};
 
-  std::string bytecode(reinterpret_cast<char *>(raw_buffer), bytecode_length);
-  std::string encoding(encoding_length, '\0');
+  auto disassembler = unwrap_disassembler(env, info, arg_count, args.data());
 
-  auto bytecode_buffer = bytecode.data();
+  std::string_view bytecode;
 
-  napi_get_buffer_info(env, args.at(0), reinterpret_cast<void **>(&bytecode_buffer), &bytecode_length);
-  napi_get_value_string_utf8(env, args.at(1), &encoding[0], encoding.size() + 1, nullptr);
+  if (!get_bytes(env, args.at(0), bytecode))
+  {
+    return nullptr;
+  }
 
-  const auto disassembly = sld::disassemble_bytecode(bytecode, encoding == "roblox" ? sld::BytecodeEncoding::Roblox : sld::BytecodeEncoding::Luau);
+  const auto disassembly = disassembler->disassemble_bytecode(bytecode, get_options(env, args.at(1)));
 
   if (!disassembly.has_value())
   {
-    napi_throw_error(env, nullptr, "Invalid bytecode version detected");
+    throw_error(env, disassembler->last_error());
+    return nullptr;
   }
 
+  return make_string(env, disassembly.value());
+}
+
+napi_value disassembler_reset(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 0;
+
+  auto disassembler = unwrap_disassembler(env, info, arg_count, nullptr);
+  disassembler->reset();
+
+  return nullptr;
+}
+
+napi_value disassembler_retained_bytes(napi_env env, napi_callback_info info)
+{
+  size_t arg_count = 0;
+
+  auto disassembler = unwrap_disassembler(env, info, arg_count, nullptr);
+
   napi_value result;
-  napi_create_string_utf8(env, disassembly.value().data(), disassembly.value().size(), &result);
+  napi_create_double(env, double(disassembler->retained_bytes()), &result);
 
   return result;
 }
@@ -77,12 +1865,86 @@ napi_value init(napi_env env, napi_value exports)
 {
   napi_value disassemble_script;
   napi_value disassemble_bytecode;
+  napi_value disassemble_script_async;
+  napi_value disassemble_bytecode_async;
+  napi_value disassemble_file;
+  napi_value disassemble_file_async;
+  napi_value disassemble_many;
+  napi_value disassemble_scripts;
+  napi_value disassemble_chunks;
+  napi_value resume_chunks;
+  napi_value cancel_chunks;
+  napi_value decode_bytecode;
+  napi_value inspect_bytecode;
+  napi_value disassemble_function;
+  napi_value control_flow;
+  napi_value export_control_flow;
+  napi_value register_encoding;
+  napi_value configure_cache;
+  napi_value get_cache_stats;
+  napi_value clear_cache;
+  napi_value save_cache;
+  napi_value load_cache;
+  napi_value detect_encoding;
+  napi_value disassembler_class;
 
   napi_create_function(env, "disassemble", sizeof("disassemble"), script_disassemble, nullptr, &disassemble_script);
   napi_create_function(env, "disassembleBytecode", sizeof("disassembleBytecode"), bytecode_disassemble, nullptr, &disassemble_bytecode);
+  napi_create_function(env, "disassembleAsync", sizeof("disassembleAsync"), script_disassemble_async, nullptr, &disassemble_script_async);
+  napi_create_function(env, "disassembleBytecodeAsync", sizeof("disassembleBytecodeAsync"), bytecode_disassemble_async, nullptr, &disassemble_bytecode_async);
+  napi_create_function(env, "disassembleFile", sizeof("disassembleFile"), file_disassemble, nullptr, &disassemble_file);
+  napi_create_function(env, "disassembleFileAsync", sizeof("disassembleFileAsync"), file_disassemble_async, nullptr, &disassemble_file_async);
+  napi_create_function(env, "disassembleMany", sizeof("disassembleMany"), bytecode_disassemble_many, nullptr, &disassemble_many);
+  napi_create_function(env, "disassembleScripts", sizeof("disassembleScripts"), script_disassemble_many, nullptr, &disassemble_scripts);
+  napi_create_function(env, "disassembleBytecodeChunks", sizeof("disassembleBytecodeChunks"), bytecode_disassemble_chunks, nullptr, &disassemble_chunks);
+  napi_create_function(env, "resumeChunks", sizeof("resumeChunks"), chunks_resume, nullptr, &resume_chunks);
+  napi_create_function(env, "cancelChunks", sizeof("cancelChunks"), chunks_cancel, nullptr, &cancel_chunks);
+  napi_create_function(env, "decodeBytecodeColumns", sizeof("decodeBytecodeColumns"), bytecode_decode, nullptr, &decode_bytecode);
+  napi_create_function(env, "inspectColumns", sizeof("inspectColumns"), bytecode_inspect, nullptr, &inspect_bytecode);
+  napi_create_function(env, "disassembleFunction", sizeof("disassembleFunction"), function_disassemble, nullptr, &disassemble_function);
+  napi_create_function(env, "controlFlowColumns", sizeof("controlFlowColumns"), bytecode_control_flow, nullptr, &control_flow);
+  napi_create_function(env, "exportControlFlowGraph", sizeof("exportControlFlowGraph"), bytecode_export_control_flow, nullptr, &export_control_flow);
+  napi_create_function(env, "configureCache", sizeof("configureCache"), cache_configure, nullptr, &configure_cache);
+  napi_create_function(env, "cacheStats", sizeof("cacheStats"), cache_stats, nullptr, &get_cache_stats);
+  napi_create_function(env, "clearCache", sizeof("clearCache"), cache_clear, nullptr, &clear_cache);
+  napi_create_function(env, "saveCache", sizeof("saveCache"), cache_save, nullptr, &save_cache);
+  napi_create_function(env, "loadCache", sizeof("loadCache"), cache_load, nullptr, &load_cache);
+  napi_create_function(env, "registerEncoding", sizeof("registerEncoding"), encoding_register, nullptr, &register_encoding);
+  napi_create_function(env, "detectEncoding", sizeof("detectEncoding"), encoding_detect, nullptr, &detect_encoding);
+
+  const std::array<napi_property_descriptor, 4> disassembler_properties{{
+      {"disassemble", nullptr, disassembler_disassemble, nullptr, nullptr, nullptr, napi_default, nullptr},
+      {"disassembleBytecode", nullptr, disassembler_disassemble_bytecode, nullptr, nullptr, nullptr, napi_default, nullptr},
+      {"reset", nullptr, disassembler_reset, nullptr, nullptr, nullptr, napi_default, nullptr},
+      {"retainedBytes", nullptr, nullptr, disassembler_retained_bytes, nullptr, nullptr, napi_default, nullptr},
+  }};
+
+  napi_define_class(env, "Disassembler", NAPI_AUTO_LENGTH, disassembler_constructor, nullptr, disassembler_properties.size(), disassembler_properties.data(), &disassembler_class);
 
   napi_set_named_property(env, exports, "disassemble", disassemble_script);
   napi_set_named_property(env, exports, "disassembleBytecode", disassemble_bytecode);
+  napi_set_named_property(env, exports, "disassembleAsync", disassemble_script_async);
+  napi_set_named_property(env, exports, "disassembleBytecodeAsync", disassemble_bytecode_async);
+  napi_set_named_property(env, exports, "disassembleFile", disassemble_file);
+  napi_set_named_property(env, exports, "disassembleFileAsync", disassemble_file_async);
+  napi_set_named_property(env, exports, "disassembleMany", disassemble_many);
+  napi_set_named_property(env, exports, "disassembleScripts", disassemble_scripts);
+  napi_set_named_property(env, exports, "disassembleBytecodeChunks", disassemble_chunks);
+  napi_set_named_property(env, exports, "resumeChunks", resume_chunks);
+  napi_set_named_property(env, exports, "cancelChunks", cancel_chunks);
+  napi_set_named_property(env, exports, "decodeBytecodeColumns", decode_bytecode);
+  napi_set_named_property(env, exports, "inspectColumns", inspect_bytecode);
+  napi_set_named_property(env, exports, "disassembleFunction", disassemble_function);
+  napi_set_named_property(env, exports, "controlFlowColumns", control_flow);
+  napi_set_named_property(env, exports, "exportControlFlowGraph", export_control_flow);
+  napi_set_named_property(env, exports, "registerEncoding", register_encoding);
+  napi_set_named_property(env, exports, "configureCache", configure_cache);
+  napi_set_named_property(env, exports, "cacheStats", get_cache_stats);
+  napi_set_named_property(env, exports, "clearCache", clear_cache);
+  napi_set_named_property(env, exports, "saveCache", save_cache);
+  napi_set_named_property(env, exports, "loadCache", load_cache);
+  napi_set_named_property(env, exports, "detectEncoding", detect_encoding);
+  napi_set_named_property(env, exports, "Disassembler", disassembler_class);
 
   return exports;
 }
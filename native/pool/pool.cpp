@@ -0,0 +1,187 @@
+#include "pool.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+// set on pool threads so that nested parallel_for calls run inline instead of waiting on themselves
+thread_local bool in_pool_worker = false;
+
+struct sld::ThreadPool::Job
+{
+  // a contiguous run of indices owned by one participant, others take from the back when stealing
+  struct Range
+  {
+    std::mutex mutex;
+    size_t begin = 0;
+    size_t end = 0;
+  };
+
+  const std::function<void(size_t)> *fn = nullptr;
+  size_t count = 0;
+
+  std::vector<Range> ranges;
+  std::atomic<size_t> participants{0};
+  std::atomic<size_t> completed{0};
+
+  std::mutex mutex;
+  std::condition_variable done;
+};
+
+sld::ThreadPool &sld::ThreadPool::shared()
+{
+  static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
+
+sld::ThreadPool::ThreadPool(size_t threads)
+{
+  workers.reserve(threads);
+
+  for (size_t i = 0; i < threads; ++i)
+  {
+    workers.emplace_back([this]()
+                         { work(); });
+  }
+}
+
+sld::ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+
+  wake.notify_all();
+
+  for (auto &worker : workers)
+  {
+    worker.join();
+  }
+}
+
+void sld::ThreadPool::parallel_for(size_t count, const std::function<void(size_t)> &fn)
+{
+  if (count == 0)
+  {
+    return;
+  }
+
+  if (in_pool_worker || workers.empty() || count == 1)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      fn(i);
+    }
+
+    return;
+  }
+
+  auto job = std::make_shared<Job>();
+  job->fn = &fn;
+  job->count = count;
+
+  // the caller takes part as well, hence one more range than there are workers
+  const size_t range_count = std::min(count, workers.size() + 1);
+  job->ranges = std::vector<Job::Range>(range_count);
+
+  for (size_t i = 0; i < range_count; ++i)
+  {
+    job->ranges[i].begin = count * i / range_count;
+    job->ranges[i].end = count * (i + 1) / range_count;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(job);
+  }
+
+  wake.notify_all();
+
+  participate(*job, job->participants++);
+
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->done.wait(lock, [&]()
+                 { return job->completed.load() == job->count; });
+}
+
+void sld::ThreadPool::work()
+{
+  in_pool_worker = true;
+
+  for (;;)
+  {
+    std::shared_ptr<Job> job;
+
+    {
+      std::unique_lock<std::mutex> lock(mutex);
+      wake.wait(lock, [&]()
+                { return stopping || !jobs.empty(); });
+
+      if (stopping)
+      {
+        return;
+      }
+
+      job = jobs.front();
+    }
+
+    participate(*job, job->participants++);
+
+    // nothing is left to claim in this job, so stop handing it out
+    std::lock_guard<std::mutex> lock(mutex);
+
+    if (!jobs.empty() && jobs.front() == job)
+    {
+      jobs.pop_front();
+    }
+  }
+}
+
+void sld::ThreadPool::participate(Job &job, size_t home)
+{
+  const size_t range_count = job.ranges.size();
+
+  auto claim = [&](size_t &index) -> bool
+  {
+    // own range first, from the front
+    if (home < range_count)
+    {
+      auto &range = job.ranges[home];
+      std::lock_guard<std::mutex> lock(range.mutex);
+
+      if (range.begin < range.end)
+      {
+        index = range.begin++;
+        return true;
+      }
+    }
+
+    // then steal from the back of the others
+    for (size_t i = 1; i <= range_count; ++i)
+    {
+      auto &range = job.ranges[(home + i) % range_count];
+      std::lock_guard<std::mutex> lock(range.mutex);
+
+      if (range.begin < range.end)
+      {
+        index = --range.end;
+        return true;
+      }
+    }
+
+    return false;
+  };
+
+  size_t index = 0;
+
+  while (claim(index))
+  {
+    (*job.fn)(index);
+
+    if (job.completed.fetch_add(1) + 1 == job.count)
+    {
+      std::lock_guard<std::mutex> lock(job.mutex);
+      job.done.notify_all();
+    }
+  }
+}
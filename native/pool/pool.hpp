@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace sld
+{
+  // fixed set of worker threads that split index ranges between themselves and steal from each other once their own
+  // range runs dry, so uneven inputs (one huge file among many small ones) don't leave cores idle
+  class ThreadPool
+  {
+  public:
+    // one pool per process, sized to the machine
+    static ThreadPool &shared();
+
+    explicit ThreadPool(size_t threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const
+    {
+      return workers.size();
+    }
+
+    // calls fn(index) for every index in [0, count) and returns once all of them finished; the calling thread takes
+    // part in the work, and calls made from inside a pool worker run inline so nested use can't deadlock
+    void parallel_for(size_t count, const std::function<void(size_t)> &fn);
+
+  private:
+    struct Job;
+
+    void work();
+    static void participate(Job &job, size_t home);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<std::shared_ptr<Job>> jobs;
+    bool stopping = false;
+  };
+}